@@ -0,0 +1,74 @@
+#pragma once
+
+#include "graph.h"
+#include "shortest_path_tree.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+struct AllowAllEdges {
+    bool operator()(EdgeId) const {
+        return true;
+    }
+};
+
+// Кратчайший путь из from в to алгоритмом A*. heuristic(vertex) должна оценивать
+// вес пути от vertex до to снизу, иначе найденный путь может оказаться не кратчайшим.
+// Рёбра, для которых is_edge_allowed возвращает false, не используются
+template <typename Weight, typename Heuristic, typename EdgeFilter = AllowAllEdges>
+std::optional<typename ShortestPathTree<Weight>::Route> FindRouteAStar(const DirectedWeightedGraph<Weight>& graph,
+                                                                       VertexId from, VertexId to,
+                                                                       Heuristic heuristic,
+                                                                       EdgeFilter is_edge_allowed = {}) {
+    struct Label {
+        Weight weight{};
+        EdgeId prev_edge = 0;
+        bool has_prev_edge = false;
+        bool reached = false;
+    };
+    std::vector<Label> labels(graph.GetVertexCount());
+    labels[from].reached = true;
+
+    // Элементы очереди: оценка полного пути, вес пройденной части, вершина
+    using QueueItem = std::tuple<Weight, Weight, VertexId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    queue.push({heuristic(from), Weight{}, from});
+    while (!queue.empty()) {
+        const auto [estimate, weight, vertex] = queue.top();
+        queue.pop();
+        if (labels[vertex].weight < weight) {
+            continue;
+        }
+        if (vertex == to) {
+            std::vector<EdgeId> edges;
+            for (const Label* label = &labels[to]; label->has_prev_edge;
+                 label = &labels[graph.GetEdge(label->prev_edge).from]) {
+                edges.push_back(label->prev_edge);
+            }
+            std::reverse(edges.begin(), edges.end());
+            return typename ShortestPathTree<Weight>::Route{weight, std::move(edges)};
+        }
+        for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+            if (!is_edge_allowed(edge_id)) {
+                continue;
+            }
+            const auto& edge = graph.GetEdge(edge_id);
+            const Weight candidate_weight = weight + edge.weight;
+            Label& label = labels[edge.to];
+            if (!label.reached || candidate_weight < label.weight) {
+                label = Label{candidate_weight, edge_id, true, true};
+                queue.push({candidate_weight + heuristic(edge.to), candidate_weight, edge.to});
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+}  // namespace graph
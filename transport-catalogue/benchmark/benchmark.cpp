@@ -0,0 +1,623 @@
+// Сквозной бенчмарк справочника на синтетической сети города.
+// Сборка из каталога transport-catalogue вместе со всеми исходниками, кроме main.cpp:
+//     g++ -std=c++17 -O2 -pthread benchmark/benchmark.cpp $(ls *.cpp | grep -v main.cpp) -o benchmark
+// Запуск: ./benchmark --stops=1000 --buses=100 --layout=grid --queries=2000 --seed=42
+// Результат печатается в стандартный вывод в формате JSON
+
+#include "../json.h"
+#include "../json_builder.h"
+#include "../json_reader.h"
+#include "../request_handler.h"
+#include "../snapshot.h"
+#include "../geo.h"
+#include "../metrics.h"
+#include "../parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <optional>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+using namespace std::literals;
+
+namespace benchmark {
+
+    enum class Layout {
+        GRID,
+        RADIAL
+    };
+
+    struct Config {
+        int stops = 1000;
+        int buses = 100;
+        Layout layout = Layout::GRID;
+        // Длина маршрута в остановках равномерно распределена на [min_route_length, max_route_length]
+        int min_route_length = 5;
+        int max_route_length = 30;
+        // Вероятность дополнительной диагональной дороги между соседними остановками
+        double distance_density = 0.3;
+        int queries = 2000;
+        int maps = 1;
+        std::uint32_t seed = 42;
+        std::string engine = "all_pairs";
+        // Сбор встроенных метрик, чтобы можно было сравнить накладные расходы
+        bool metrics = true;
+        // Потоковая загрузка: справочник и граф строятся одновременно с разбором
+        bool pipeline = false;
+        // Потоки отрисовки карты, 0 - все доступные
+        int render_threads = 1;
+    };
+
+    enum class QueryType {
+        BUS,
+        STOP,
+        ROUTE,
+        MAP
+    };
+
+    struct Query {
+        QueryType type;
+        std::string first;
+        std::string second;
+    };
+
+    struct Network {
+        std::vector<std::string> stop_names;
+        std::vector<std::string> bus_names;
+        std::vector<Query> queries;
+        std::string input;
+    };
+
+    // Детерминированные случайные числа: распределения стандартной библиотеки
+    // зависят от реализации, поэтому выборка делается вручную поверх mt19937
+    class Random {
+    public:
+        explicit Random(std::uint32_t seed) : engine_(seed) {}
+
+        int NextInt(int from, int to) {
+            return from + static_cast<int>(engine_() % static_cast<std::uint32_t>(to - from + 1));
+        }
+
+        double NextDouble() {
+            return engine_() / (static_cast<double>(std::mt19937::max()) + 1.0);
+        }
+
+    private:
+        std::mt19937 engine_;
+    };
+
+    class NetworkGenerator {
+    public:
+        explicit NetworkGenerator(const Config& config) : config_(config), random_(config.seed) {}
+
+        Network Generate() {
+            if (config_.layout == Layout::GRID) {
+                PlaceGrid();
+            } else {
+                PlaceRadial();
+            }
+
+            Network network;
+            json::Array base_requests;
+            for (int stop = 0; stop < config_.stops; ++stop) {
+                network.stop_names.push_back(StopName(stop));
+            }
+            for (int stop = 0; stop < config_.stops; ++stop) {
+                json::Dict road_distances;
+                for (const auto& [to, distance] : road_distances_[stop]) {
+                    road_distances[StopName(to)] = distance;
+                }
+                base_requests.push_back(json::Dict{
+                    {"type"s, "Stop"s},
+                    {"name"s, network.stop_names[stop]},
+                    {"latitude"s, points_[stop].lat},
+                    {"longitude"s, points_[stop].lng},
+                    {"road_distances"s, std::move(road_distances)}
+                });
+            }
+            for (int bus = 0; bus < config_.buses; ++bus) {
+                const bool is_roundtrip = random_.NextInt(0, 1) == 1;
+                json::Array stops;
+                for (const int stop : MakeRoute(is_roundtrip)) {
+                    stops.push_back(network.stop_names[stop]);
+                }
+                network.bus_names.push_back("Bus "s + std::to_string(bus));
+                base_requests.push_back(json::Dict{
+                    {"type"s, "Bus"s},
+                    {"name"s, network.bus_names.back()},
+                    {"stops"s, std::move(stops)},
+                    {"is_roundtrip"s, is_roundtrip}
+                });
+            }
+
+            json::Array stat_requests;
+            MakeQueries(network);
+            for (std::size_t id = 0; id < network.queries.size(); ++id) {
+                const Query& query = network.queries[id];
+                json::Dict request{{"id"s, static_cast<int>(id)}};
+                switch (query.type) {
+                case QueryType::BUS:
+                    request["type"s] = "Bus"s;
+                    request["name"s] = query.first;
+                    break;
+                case QueryType::STOP:
+                    request["type"s] = "Stop"s;
+                    request["name"s] = query.first;
+                    break;
+                case QueryType::ROUTE:
+                    request["type"s] = "Route"s;
+                    request["from"s] = query.first;
+                    request["to"s] = query.second;
+                    break;
+                case QueryType::MAP:
+                    request["type"s] = "Map"s;
+                    break;
+                }
+                stat_requests.push_back(std::move(request));
+            }
+
+            const json::Document document(json::Dict{
+                {"base_requests"s, std::move(base_requests)},
+                {"render_settings"s, MakeRenderSettings()},
+                {"routing_settings"s, json::Dict{
+                    {"bus_wait_time"s, 6},
+                    {"bus_velocity"s, 40},
+                    {"engine"s, config_.engine}
+                }},
+                {"stat_requests"s, std::move(stat_requests)}
+            });
+            std::ostringstream out;
+            json::Print(document, out);
+            network.input = out.str();
+            return network;
+        }
+
+    private:
+        // Шаг между соседними остановками в градусах, около 450 метров
+        static constexpr double STEP = 0.004;
+        static constexpr double CENTER_LAT = 55.75;
+        static constexpr double CENTER_LNG = 37.62;
+
+        const Config& config_;
+        Random random_;
+        std::vector<geo::Coordinates> points_;
+        std::vector<std::vector<int>> links_;
+        std::vector<std::map<int, int>> road_distances_;
+
+        static std::string StopName(int stop) {
+            return "Stop "s + std::to_string(stop);
+        }
+
+        double Jitter() {
+            return (random_.NextDouble() - 0.5) * STEP * 0.3;
+        }
+
+        void Resize() {
+            points_.resize(config_.stops);
+            links_.resize(config_.stops);
+            road_distances_.resize(config_.stops);
+        }
+
+        // Дорога задаётся в одну сторону, обратное расстояние справочник берёт из неё же
+        void AddLink(int from, int to) {
+            const double straight = geo::ComputeDistance(points_[from], points_[to]);
+            const int distance = std::max(1, static_cast<int>(straight * (1.1 + 0.4 * random_.NextDouble())));
+            road_distances_[from][to] = distance;
+            links_[from].push_back(to);
+            links_[to].push_back(from);
+        }
+
+        void AddExtraLink(int from, int to) {
+            if (random_.NextDouble() < config_.distance_density) {
+                AddLink(from, to);
+            }
+        }
+
+        void PlaceGrid() {
+            Resize();
+            const int side = std::max(1, static_cast<int>(std::ceil(std::sqrt(config_.stops))));
+            for (int stop = 0; stop < config_.stops; ++stop) {
+                const int row = stop / side;
+                const int column = stop % side;
+                points_[stop] = {CENTER_LAT + (row - side / 2) * STEP + Jitter(),
+                                 CENTER_LNG + (column - side / 2) * STEP * 1.7 + Jitter()};
+            }
+            for (int stop = 0; stop < config_.stops; ++stop) {
+                const int column = stop % side;
+                if (column + 1 < side && stop + 1 < config_.stops) {
+                    AddLink(stop, stop + 1);
+                }
+                if (stop + side < config_.stops) {
+                    AddLink(stop, stop + side);
+                }
+                if (column + 1 < side && stop + side + 1 < config_.stops) {
+                    AddExtraLink(stop, stop + side + 1);
+                }
+            }
+        }
+
+        // Остановка 0 - центр, остальные лежат на кольцах по лучам
+        void PlaceRadial() {
+            Resize();
+            const int spokes = std::max(4, static_cast<int>(std::lround(std::sqrt(config_.stops))));
+            auto ring_of = [spokes](int stop) {
+                return (stop - 1) / spokes + 1;
+            };
+            points_[0] = {CENTER_LAT, CENTER_LNG};
+            for (int stop = 1; stop < config_.stops; ++stop) {
+                const double angle = 2 * M_PI * ((stop - 1) % spokes) / spokes;
+                const double radius = ring_of(stop) * STEP;
+                points_[stop] = {CENTER_LAT + radius * std::sin(angle) + Jitter(),
+                                 CENTER_LNG + radius * std::cos(angle) * 1.7 + Jitter()};
+            }
+            for (int stop = 1; stop < config_.stops; ++stop) {
+                const int spoke = (stop - 1) % spokes;
+                const int next_on_ring = spoke + 1 < spokes ? stop + 1 : stop + 1 - spokes;
+                AddLink(ring_of(stop) == 1 ? 0 : stop - spokes, stop);
+                if (next_on_ring < config_.stops && next_on_ring != stop) {
+                    AddLink(stop, next_on_ring);
+                }
+                if (ring_of(stop) > 1 && next_on_ring - spokes > 0) {
+                    AddExtraLink(stop, next_on_ring - spokes);
+                }
+            }
+        }
+
+        // Случайное блуждание по дорогам, по возможности без повторных остановок.
+        // Кольцевой маршрут возвращается к началу кратчайшим по числу остановок путём
+        std::vector<int> MakeRoute(bool is_roundtrip) {
+            const int length = random_.NextInt(config_.min_route_length, config_.max_route_length);
+            std::vector<int> route = {random_.NextInt(0, config_.stops - 1)};
+            std::vector<char> visited(config_.stops, false);
+            visited[route.back()] = true;
+            while (static_cast<int>(route.size()) < length && !links_[route.back()].empty()) {
+                const auto& links = links_[route.back()];
+                std::vector<int> fresh;
+                std::copy_if(links.begin(), links.end(), std::back_inserter(fresh), [&visited](int stop) {
+                    return !visited[stop];
+                });
+                const auto& candidates = fresh.empty() ? links : fresh;
+                route.push_back(candidates[random_.NextInt(0, static_cast<int>(candidates.size()) - 1)]);
+                visited[route.back()] = true;
+            }
+            if (is_roundtrip) {
+                const std::vector<int> way_back = FindPath(route.back(), route.front());
+                route.insert(route.end(), way_back.begin() + 1, way_back.end());
+            }
+            return route;
+        }
+
+        std::vector<int> FindPath(int from, int to) const {
+            std::vector<int> prev(config_.stops, -1);
+            std::queue<int> queue;
+            queue.push(from);
+            prev[from] = from;
+            while (!queue.empty() && prev[to] == -1) {
+                const int stop = queue.front();
+                queue.pop();
+                for (const int next : links_[stop]) {
+                    if (prev[next] == -1) {
+                        prev[next] = stop;
+                        queue.push(next);
+                    }
+                }
+            }
+            std::vector<int> path = {to};
+            while (path.back() != from) {
+                path.push_back(prev[path.back()]);
+            }
+            std::reverse(path.begin(), path.end());
+            return path;
+        }
+
+        void MakeQueries(Network& network) {
+            for (int i = 0; i < config_.queries; ++i) {
+                const int kind = random_.NextInt(0, 9);
+                if (kind < 3 && !network.bus_names.empty()) {
+                    network.queries.push_back({QueryType::BUS,
+                        network.bus_names[random_.NextInt(0, config_.buses - 1)], {}});
+                } else if (kind < 6) {
+                    network.queries.push_back({QueryType::STOP,
+                        network.stop_names[random_.NextInt(0, config_.stops - 1)], {}});
+                } else {
+                    network.queries.push_back({QueryType::ROUTE,
+                        network.stop_names[random_.NextInt(0, config_.stops - 1)],
+                        network.stop_names[random_.NextInt(0, config_.stops - 1)]});
+                }
+            }
+            for (int i = 0; i < config_.maps; ++i) {
+                network.queries.push_back({QueryType::MAP, {}, {}});
+            }
+        }
+
+        json::Dict MakeRenderSettings() const {
+            return json::Dict{
+                {"width"s, 1200.0},
+                {"height"s, 1200.0},
+                {"padding"s, 50.0},
+                {"line_width"s, 14.0},
+                {"stop_radius"s, 5.0},
+                {"bus_label_font_size"s, 20},
+                {"bus_label_offset"s, json::Array{7.0, 15.0}},
+                {"stop_label_font_size"s, 18},
+                {"stop_label_offset"s, json::Array{7.0, -3.0}},
+                {"underlayer_color"s, json::Array{255, 255, 255, 0.85}},
+                {"underlayer_width"s, 3.0},
+                {"color_palette"s, json::Array{"green"s, json::Array{255, 160, 0}, "red"s}},
+                {"render_threads"s, config_.render_threads}
+            };
+        }
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    template <typename Function>
+    double MeasureMs(Function function) {
+        const auto start = Clock::now();
+        function();
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // Перцентиль по методу ближайшего ранга, latencies отсортированы
+    double Percentile(const std::vector<double>& latencies, double percent) {
+        if (latencies.empty()) {
+            return 0.0;
+        }
+        const auto rank = static_cast<std::size_t>(std::ceil(percent / 100.0 * latencies.size()));
+        return latencies[std::max<std::size_t>(rank, 1) - 1];
+    }
+
+    // Пиковый размер резидентной памяти процесса, если платформа его сообщает
+    std::optional<long long> GetPeakRss() {
+#if defined(__unix__) || defined(__APPLE__)
+        rusage usage{};
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+            return static_cast<long long>(usage.ru_maxrss);
+#else
+            return static_cast<long long>(usage.ru_maxrss) * 1024;
+#endif
+        }
+#endif
+        return std::nullopt;
+    }
+
+    // Размеры печатаются точно, пока помещаются в int
+    json::Node SizeNode(std::uint64_t value) {
+        if (value <= static_cast<std::uint64_t>(std::numeric_limits<int>::max())) {
+            return static_cast<int>(value);
+        }
+        return static_cast<double>(value);
+    }
+
+    json::Node PhaseNode(double ms, double units, const std::string& unit_name) {
+        return json::Builder{}
+            .StartDict()
+                .Key("ms").Value(ms)
+                .Key(unit_name + "_per_second").Value(ms > 0 ? units * 1000.0 / ms : 0.0)
+            .EndDict()
+            .Build();
+    }
+
+    json::Node QueryNode(std::vector<double> latencies) {
+        std::sort(latencies.begin(), latencies.end());
+        double total_us = 0.0;
+        for (const double latency : latencies) {
+            total_us += latency;
+        }
+        return json::Builder{}
+            .StartDict()
+                .Key("count").Value(static_cast<int>(latencies.size()))
+                .Key("total_ms").Value(total_us / 1000.0)
+                .Key("queries_per_second").Value(total_us > 0 ? latencies.size() * 1e6 / total_us : 0.0)
+                .Key("p50_us").Value(Percentile(latencies, 50))
+                .Key("p90_us").Value(Percentile(latencies, 90))
+                .Key("p99_us").Value(Percentile(latencies, 99))
+                .Key("max_us").Value(latencies.empty() ? 0.0 : latencies.back())
+            .EndDict()
+            .Build();
+    }
+
+    Config ParseArguments(int argc, char** argv) {
+        Config config;
+        for (int i = 1; i < argc; ++i) {
+            const std::string argument = argv[i];
+            const auto equals = argument.find('=');
+            if (argument.rfind("--", 0) != 0 || equals == std::string::npos) {
+                throw std::invalid_argument("Bad argument "s + argument);
+            }
+            const std::string key = argument.substr(2, equals - 2);
+            const std::string value = argument.substr(equals + 1);
+            if (key == "stops") {
+                config.stops = std::stoi(value);
+            } else if (key == "buses") {
+                config.buses = std::stoi(value);
+            } else if (key == "layout") {
+                if (value != "grid" && value != "radial") {
+                    throw std::invalid_argument("Unknown layout "s + value);
+                }
+                config.layout = value == "grid" ? Layout::GRID : Layout::RADIAL;
+            } else if (key == "min_route_length") {
+                config.min_route_length = std::stoi(value);
+            } else if (key == "max_route_length") {
+                config.max_route_length = std::stoi(value);
+            } else if (key == "distance_density") {
+                config.distance_density = std::stod(value);
+            } else if (key == "queries") {
+                config.queries = std::stoi(value);
+            } else if (key == "maps") {
+                config.maps = std::stoi(value);
+            } else if (key == "seed") {
+                config.seed = static_cast<std::uint32_t>(std::stoul(value));
+            } else if (key == "engine") {
+                config.engine = value;
+            } else if (key == "metrics") {
+                config.metrics = value != "0";
+            } else if (key == "pipeline") {
+                config.pipeline = value != "0";
+            } else if (key == "render_threads") {
+                config.render_threads = std::stoi(value);
+            } else {
+                throw std::invalid_argument("Unknown option "s + key);
+            }
+        }
+        if (config.stops < 2 || config.buses < 0 || config.min_route_length < 2
+            || config.max_route_length < config.min_route_length || config.queries < 0 || config.maps < 0
+            || config.render_threads < 0) {
+            throw std::invalid_argument("Bad benchmark configuration"s);
+        }
+        return config;
+    }
+
+    json::Node Run(const Config& config) {
+        metrics::SetEnabled(config.metrics);
+        Network network = NetworkGenerator(config).Generate();
+        const double input_mb = network.input.size() / 1e6;
+
+        std::optional<json::Document> document;
+        const double load_ms = MeasureMs([&] {
+            std::istringstream input(network.input);
+            document = json::Load(input);
+        });
+        // Тот же вход двухэтапным разбором во всех потоках, им пользуется JsonReader
+        const double parallel_load_ms = MeasureMs([&] {
+            json::LoadParallel(network.input, parallel::GetThreadCount());
+        });
+
+        std::istringstream input(network.input);
+        auto snapshot = std::make_unique<transport_catalogue::Snapshot>();
+        std::optional<json_reader::JsonReader> reader;
+        if (!config.pipeline) {
+            reader.emplace(input);
+        }
+        // При потоковой загрузке сюда входят разбор входа и построение графа маршрутизатора
+        const double apply_ms = MeasureMs([&] {
+            if (config.pipeline) {
+                reader.emplace(input, snapshot->GetCatalogue(), snapshot->GetRouter());
+            } else {
+                reader->ApplyCommands(snapshot->GetCatalogue());
+            }
+            snapshot->GetCatalogue().Freeze();
+        });
+        reader->ApplyRenderSettingsCommands(snapshot->GetRenderer());
+        const double router_ms = MeasureMs([&] {
+            reader->ApplyRouteSettingsCommands(snapshot->GetRouter());
+        });
+
+        const transport_catalogue::RequestHandler handler(*snapshot);
+        std::map<std::string, std::vector<double>> latencies;
+        for (const Query& query : network.queries) {
+            const auto start = Clock::now();
+            switch (query.type) {
+            case QueryType::BUS:
+                handler.GetBusStat(query.first);
+                break;
+            case QueryType::STOP:
+                handler.GetBusesByStop(query.first);
+                break;
+            case QueryType::ROUTE:
+                handler.GetRouteInfo(query.first, query.second);
+                break;
+            case QueryType::MAP: {
+                std::ostringstream map_out;
+                handler.RenderMap().Render(map_out);
+                break;
+            }
+            }
+            const double latency = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+            static const char* const NAMES[] = {"Bus", "Stop", "Route", "Map"};
+            latencies[NAMES[static_cast<int>(query.type)]].push_back(latency);
+        }
+
+        std::ostringstream print_out;
+        const double print_ms = MeasureMs([&] {
+            json::Print(*document, print_out);
+        });
+
+        std::ostringstream stat_out;
+        const double stat_ms = MeasureMs([&] {
+            reader->PrintJson(handler, stat_out);
+        });
+
+        json::Dict queries;
+        for (auto& [type, type_latencies] : latencies) {
+            queries[type] = QueryNode(std::move(type_latencies));
+        }
+        memory::Report memory_report = handler.GetMemoryReport();
+        memory_report.push_back(reader->GetDocumentMemoryUsage());
+        json::Array memory;
+        for (const auto& usage : memory_report) {
+            memory.push_back(json::Dict{
+                {"name"s, usage.name},
+                {"count"s, SizeNode(usage.count)},
+                {"bytes"s, SizeNode(usage.bytes)}
+            });
+        }
+        const auto peak_rss = GetPeakRss();
+
+        return json::Builder{}
+            .StartDict()
+                .Key("config").StartDict()
+                    .Key("stops").Value(config.stops)
+                    .Key("buses").Value(config.buses)
+                    .Key("layout").Value(config.layout == Layout::GRID ? "grid"s : "radial"s)
+                    .Key("min_route_length").Value(config.min_route_length)
+                    .Key("max_route_length").Value(config.max_route_length)
+                    .Key("distance_density").Value(config.distance_density)
+                    .Key("queries").Value(config.queries)
+                    .Key("maps").Value(config.maps)
+                    .Key("seed").Value(static_cast<int>(config.seed))
+                    .Key("engine").Value(config.engine)
+                    .Key("metrics").Value(config.metrics)
+                    .Key("pipeline").Value(config.pipeline)
+                    .Key("render_threads").Value(config.render_threads)
+                .EndDict()
+                .Key("input_bytes").Value(static_cast<int>(network.input.size()))
+                .Key("phases").StartDict()
+                    .Key("json_load").Value(PhaseNode(load_ms, input_mb, "mb"))
+                    .Key("json_load_parallel").Value(PhaseNode(parallel_load_ms, input_mb, "mb"))
+                    .Key("apply_commands").Value(PhaseNode(apply_ms, config.stops + config.buses, "items"))
+                    .Key("router_build").Value(PhaseNode(router_ms, config.stops, "stops"))
+                    .Key("json_print").Value(PhaseNode(print_ms, print_out.str().size() / 1e6, "mb"))
+                    .Key("stat_requests").Value(PhaseNode(stat_ms, network.queries.size(), "requests"))
+                .EndDict()
+                .Key("queries").Value(std::move(queries))
+                .Key("memory").Value(std::move(memory))
+                .Key("memory_total_bytes").Value(SizeNode(memory::GetTotalBytes(memory_report)))
+                .Key("peak_rss_bytes").Value(peak_rss ? SizeNode(static_cast<std::uint64_t>(*peak_rss)) : json::Node(nullptr))
+            .EndDict()
+            .Build();
+    }
+
+}  // namespace benchmark
+
+int main(int argc, char** argv) {
+    try {
+        const benchmark::Config config = benchmark::ParseArguments(argc, argv);
+        json::Print(json::Document(benchmark::Run(config)), std::cout);
+        std::cout << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl
+                  << "Usage: benchmark [--stops=N] [--buses=N] [--layout=grid|radial]"
+                     " [--min_route_length=N] [--max_route_length=N] [--distance_density=P]"
+                     " [--queries=N] [--maps=N] [--seed=N] [--engine=NAME] [--metrics=0|1]"
+                     " [--pipeline=0|1] [--render_threads=N]" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "graph.h"
+#include "shortest_path_tree.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Кратчайший путь из from в to двунаправленным алгоритмом Дейкстры: прямой поиск идёт
+// от from по исходящим рёбрам, обратный - от to по входящим. Шаг делает поиск
+// с меньшим весом в голове очереди. Поиск заканчивается, когда сумма весов в головах
+// очередей не меньше лучшего найденного пути через встреченную обоими поисками вершину
+template <typename Weight>
+std::optional<typename ShortestPathTree<Weight>::Route> FindRouteBidirectional(const DirectedWeightedGraph<Weight>& graph,
+                                                                               VertexId from, VertexId to) {
+    struct Label {
+        Weight weight{};
+        EdgeId edge = 0;
+        bool has_edge = false;
+        bool reached = false;
+    };
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    // Для прямого поиска edge - ребро, по которому пришли в вершину, для обратного - по которому из неё ушли
+    std::vector<Label> forward(graph.GetVertexCount());
+    std::vector<Label> backward(graph.GetVertexCount());
+    Queue forward_queue;
+    Queue backward_queue;
+    forward[from].reached = true;
+    backward[to].reached = true;
+    forward_queue.push({Weight{}, from});
+    backward_queue.push({Weight{}, to});
+
+    std::optional<std::pair<Weight, VertexId>> best;
+    if (from == to) {
+        best = std::pair{Weight{}, from};
+    }
+
+    // Убирает из головы очереди устаревшие элементы
+    auto skip_stale = [](Queue& queue, const std::vector<Label>& labels) {
+        while (!queue.empty() && labels[queue.top().second].weight < queue.top().first) {
+            queue.pop();
+        }
+    };
+
+    while (true) {
+        skip_stale(forward_queue, forward);
+        skip_stale(backward_queue, backward);
+        if (forward_queue.empty() || backward_queue.empty()) {
+            break;
+        }
+        if (best && !(forward_queue.top().first + backward_queue.top().first < best->first)) {
+            break;
+        }
+
+        const bool is_forward = forward_queue.top().first <= backward_queue.top().first;
+        Queue& queue = is_forward ? forward_queue : backward_queue;
+        std::vector<Label>& labels = is_forward ? forward : backward;
+        const std::vector<Label>& other_labels = is_forward ? backward : forward;
+
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        const auto edges = is_forward ? graph.GetIncidentEdges(vertex) : graph.GetIncomingEdges(vertex);
+        for (const EdgeId edge_id : edges) {
+            const auto& edge = graph.GetEdge(edge_id);
+            const VertexId next = is_forward ? edge.to : edge.from;
+            const Weight candidate_weight = weight + edge.weight;
+            Label& label = labels[next];
+            if (!label.reached || candidate_weight < label.weight) {
+                label = Label{candidate_weight, edge_id, true, true};
+                queue.push({candidate_weight, next});
+                if (other_labels[next].reached) {
+                    const Weight total_weight = candidate_weight + other_labels[next].weight;
+                    if (!best || total_weight < best->first) {
+                        best = std::pair{total_weight, next};
+                    }
+                }
+            }
+        }
+    }
+
+    if (!best) {
+        return std::nullopt;
+    }
+    std::vector<EdgeId> edges;
+    for (const Label* label = &forward[best->second]; label->has_edge;
+         label = &forward[graph.GetEdge(label->edge).from]) {
+        edges.push_back(label->edge);
+    }
+    std::reverse(edges.begin(), edges.end());
+    for (const Label* label = &backward[best->second]; label->has_edge;
+         label = &backward[graph.GetEdge(label->edge).to]) {
+        edges.push_back(label->edge);
+    }
+    return typename ShortestPathTree<Weight>::Route{best->first, std::move(edges)};
+}
+
+}  // namespace graph
@@ -0,0 +1,513 @@
+#pragma once
+
+#include "graph.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Иерархия сжатия (Contraction Hierarchies): вершины по очереди стягиваются,
+// а сохраняющие расстояния пути через них заменяются рёбрами-сокращениями.
+// Запрос - двунаправленный поиск, идущий только вверх по рангу вершин.
+// Рёбра-сокращения раскрываются в исходные рёбра графа
+template <typename Weight>
+class ContractionHierarchy {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+    using ArcId = size_t;
+
+public:
+    struct RouteInfo {
+        Weight weight;
+        std::vector<EdgeId> edges;
+    };
+
+    struct Stats {
+        double preprocessing_ms;
+        size_t original_arcs;
+        size_t shortcuts;
+        size_t memory_bytes;
+    };
+
+    explicit ContractionHierarchy(const Graph& graph, size_t thread_count = parallel::GetThreadCount());
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+
+    std::optional<Weight> GetRouteWeight(VertexId from, VertexId to) const;
+
+    const Stats& GetStats() const;
+
+private:
+    static constexpr ArcId NO_ARC = std::numeric_limits<ArcId>::max();
+    static constexpr Weight ZERO_WEIGHT{};
+    // Ограничение на число вершин, просматриваемых при поиске свидетеля.
+    // Если свидетель не найден, сокращение добавляется: это лишнее ребро, но не ошибка
+    static constexpr size_t WITNESS_SETTLE_LIMIT = 500;
+
+    // Исходное ребро графа, если first == NO_ARC, иначе сокращение из двух дуг
+    struct Arc {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+        EdgeId edge;
+        ArcId first = NO_ARC;
+        ArcId second = NO_ARC;
+    };
+
+    struct Shortcut {
+        ArcId first;
+        ArcId second;
+    };
+
+    class WitnessSearch;
+    struct Preprocessing;
+
+    struct Label {
+        Weight weight;
+        ArcId arc;
+    };
+    using Labels = std::unordered_map<VertexId, Label>;
+
+    std::vector<Arc> arcs_;
+    std::vector<size_t> rank_;
+    // Дуги вверх по рангу, исходящие из вершины
+    std::vector<size_t> up_offsets_;
+    std::vector<ArcId> up_arcs_;
+    // Дуги вверх по рангу, входящие в вершину; по ним идёт обратный поиск
+    std::vector<size_t> down_offsets_;
+    std::vector<ArcId> down_arcs_;
+    Stats stats_ = {};
+
+    void Contract(size_t thread_count);
+    void BuildSearchGraph();
+
+    std::optional<std::pair<Weight, VertexId>> Search(VertexId from, VertexId to, Labels& forward,
+                                                      Labels& backward) const;
+    void UnpackArc(ArcId arc, std::vector<EdgeId>& edges) const;
+};
+
+// Поиск свидетеля: кратчайший путь из вершины в обход запрещённых вершин.
+// Буферы переиспользуются между поисками одного потока
+template <typename Weight>
+class ContractionHierarchy<Weight>::WitnessSearch {
+public:
+    explicit WitnessSearch(size_t vertex_count)
+        : weights_(vertex_count)
+        , reached_(vertex_count, false) {
+    }
+
+    template <typename IsForbidden>
+    void Run(const ContractionHierarchy& ch, const std::vector<std::vector<ArcId>>& out_arcs, VertexId source,
+             Weight max_weight, IsForbidden is_forbidden) {
+        Reset();
+        Reach(source, ZERO_WEIGHT);
+
+        using QueueItem = std::pair<Weight, VertexId>;
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+        queue.push({ZERO_WEIGHT, source});
+        size_t settled = 0;
+        while (!queue.empty() && settled < WITNESS_SETTLE_LIMIT) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weights_[vertex] < weight) {
+                continue;
+            }
+            ++settled;
+            for (const ArcId arc_id : out_arcs[vertex]) {
+                const Arc& arc = ch.arcs_[arc_id];
+                if (is_forbidden(arc.to)) {
+                    continue;
+                }
+                const Weight candidate_weight = weight + arc.weight;
+                if (max_weight < candidate_weight) {
+                    continue;
+                }
+                if (!reached_[arc.to] || candidate_weight < weights_[arc.to]) {
+                    Reach(arc.to, candidate_weight);
+                    queue.push({candidate_weight, arc.to});
+                }
+            }
+        }
+    }
+
+    std::optional<Weight> GetWeight(VertexId vertex) const {
+        if (!reached_[vertex]) {
+            return std::nullopt;
+        }
+        return weights_[vertex];
+    }
+
+private:
+    std::vector<Weight> weights_;
+    std::vector<bool> reached_;
+    std::vector<VertexId> touched_;
+
+    void Reach(VertexId vertex, Weight weight) {
+        if (!reached_[vertex]) {
+            reached_[vertex] = true;
+            touched_.push_back(vertex);
+        }
+        weights_[vertex] = weight;
+    }
+
+    void Reset() {
+        for (const VertexId vertex : touched_) {
+            reached_[vertex] = false;
+        }
+        touched_.clear();
+    }
+};
+
+// Состояние графа во время стягивания: ещё не стянутые вершины и их дуги
+template <typename Weight>
+struct ContractionHierarchy<Weight>::Preprocessing {
+    std::vector<std::vector<ArcId>> out_arcs;
+    std::vector<std::vector<ArcId>> in_arcs;
+    std::vector<char> contracted;
+    std::vector<char> in_round;
+    std::vector<int> contracted_neighbors;
+    std::vector<int> priority;
+
+    bool IsForbidden(VertexId vertex) const {
+        return contracted[vertex] || in_round[vertex];
+    }
+};
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph, size_t thread_count) {
+    const auto start = std::chrono::steady_clock::now();
+
+    const size_t vertex_count = graph.GetVertexCount();
+    rank_.assign(vertex_count, 0);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+            const auto& edge = graph.GetEdge(edge_id);
+            if (edge.from != edge.to) {
+                arcs_.push_back(Arc{edge.from, edge.to, edge.weight, edge_id});
+            }
+        }
+    }
+    stats_.original_arcs = arcs_.size();
+
+    Contract(thread_count);
+    BuildSearchGraph();
+
+    stats_.shortcuts = arcs_.size() - stats_.original_arcs;
+    stats_.memory_bytes = sizeof(*this) + arcs_.capacity() * sizeof(Arc)
+        + rank_.capacity() * sizeof(size_t)
+        + (up_offsets_.capacity() + down_offsets_.capacity()) * sizeof(size_t)
+        + (up_arcs_.capacity() + down_arcs_.capacity()) * sizeof(ArcId);
+    stats_.preprocessing_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::Contract(size_t thread_count) {
+    const size_t vertex_count = rank_.size();
+    thread_count = std::max<size_t>(thread_count, 1);
+
+    Preprocessing state;
+    state.out_arcs.resize(vertex_count);
+    state.in_arcs.resize(vertex_count);
+    state.contracted.assign(vertex_count, false);
+    state.in_round.assign(vertex_count, false);
+    state.contracted_neighbors.assign(vertex_count, 0);
+    state.priority.assign(vertex_count, 0);
+    for (ArcId arc_id = 0; arc_id < arcs_.size(); ++arc_id) {
+        state.out_arcs[arcs_[arc_id].from].push_back(arc_id);
+        state.in_arcs[arcs_[arc_id].to].push_back(arc_id);
+    }
+
+    // Сокращения, без которых нельзя стянуть вершину
+    auto find_shortcuts = [this, &state](VertexId vertex, WitnessSearch& search) {
+        auto is_forbidden = [&state, vertex](VertexId other) {
+            return other == vertex || state.IsForbidden(other);
+        };
+        std::vector<Shortcut> shortcuts;
+        Weight max_out_weight = ZERO_WEIGHT;
+        for (const ArcId out_arc : state.out_arcs[vertex]) {
+            max_out_weight = std::max(max_out_weight, arcs_[out_arc].weight);
+        }
+        for (const ArcId in_arc : state.in_arcs[vertex]) {
+            const VertexId from = arcs_[in_arc].from;
+            if (is_forbidden(from)) {
+                continue;
+            }
+            search.Run(*this, state.out_arcs, from, arcs_[in_arc].weight + max_out_weight, is_forbidden);
+            for (const ArcId out_arc : state.out_arcs[vertex]) {
+                const VertexId to = arcs_[out_arc].to;
+                if (to == from || is_forbidden(to)) {
+                    continue;
+                }
+                const Weight via_weight = arcs_[in_arc].weight + arcs_[out_arc].weight;
+                const auto witness_weight = search.GetWeight(to);
+                if (!witness_weight || via_weight < *witness_weight) {
+                    shortcuts.push_back({in_arc, out_arc});
+                }
+            }
+        }
+        return shortcuts;
+    };
+
+    auto compute_priority = [&state, &find_shortcuts](VertexId vertex, WitnessSearch& search) {
+        const int shortcuts = static_cast<int>(find_shortcuts(vertex, search).size());
+        const int removed = static_cast<int>(state.out_arcs[vertex].size() + state.in_arcs[vertex].size());
+        return shortcuts - removed + state.contracted_neighbors[vertex];
+    };
+
+    // Каждый поток работает со своим буфером поиска и обрабатывает каждый thread_count-й элемент
+    auto for_each_parallel = [vertex_count, thread_count](const std::vector<VertexId>& vertices, auto func) {
+        parallel::ParallelFor(thread_count, [&](size_t thread_index) {
+            WitnessSearch search(vertex_count);
+            for (size_t i = thread_index; i < vertices.size(); i += thread_count) {
+                func(i, search);
+            }
+        }, thread_count);
+    };
+
+    std::vector<VertexId> remaining(vertex_count);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        remaining[vertex] = vertex;
+    }
+    for_each_parallel(remaining, [&](size_t i, WitnessSearch& search) {
+        state.priority[remaining[i]] = compute_priority(remaining[i], search);
+    });
+
+    size_t next_rank = 0;
+    while (!remaining.empty()) {
+        // Стягиваются вершины с приоритетом меньше, чем у всех соседей: они не смежны друг с другом
+        auto precedes = [&state](VertexId lhs, VertexId rhs) {
+            return std::pair{state.priority[lhs], lhs} < std::pair{state.priority[rhs], rhs};
+        };
+        std::vector<char> selected(remaining.size(), false);
+        for_each_parallel(remaining, [&](size_t i, WitnessSearch&) {
+            const VertexId vertex = remaining[i];
+            auto is_neighbor_first = [&](ArcId arc_id, bool outgoing) {
+                const VertexId other = outgoing ? arcs_[arc_id].to : arcs_[arc_id].from;
+                return !state.contracted[other] && other != vertex && precedes(other, vertex);
+            };
+            selected[i] = std::none_of(state.out_arcs[vertex].begin(), state.out_arcs[vertex].end(),
+                                       [&](ArcId arc_id) { return is_neighbor_first(arc_id, true); })
+                && std::none_of(state.in_arcs[vertex].begin(), state.in_arcs[vertex].end(),
+                                [&](ArcId arc_id) { return is_neighbor_first(arc_id, false); });
+        });
+
+        std::vector<VertexId> round;
+        std::vector<VertexId> next_remaining;
+        for (size_t i = 0; i < remaining.size(); ++i) {
+            (selected[i] ? round : next_remaining).push_back(remaining[i]);
+        }
+        for (const VertexId vertex : round) {
+            state.in_round[vertex] = true;
+        }
+
+        // Свидетели ищутся в обход всех вершин раунда, поэтому раунд можно стягивать параллельно
+        std::vector<std::vector<Shortcut>> shortcuts(round.size());
+        for_each_parallel(round, [&](size_t i, WitnessSearch& search) {
+            shortcuts[i] = find_shortcuts(round[i], search);
+        });
+
+        std::vector<VertexId> neighbors;
+        for (size_t i = 0; i < round.size(); ++i) {
+            const VertexId vertex = round[i];
+            rank_[vertex] = next_rank++;
+            state.contracted[vertex] = true;
+            for (const Shortcut& shortcut : shortcuts[i]) {
+                const Arc& first = arcs_[shortcut.first];
+                const Arc& second = arcs_[shortcut.second];
+                const ArcId arc_id = arcs_.size();
+                arcs_.push_back(Arc{first.from, second.to, first.weight + second.weight, 0, shortcut.first,
+                                    shortcut.second});
+                state.out_arcs[arcs_[arc_id].from].push_back(arc_id);
+                state.in_arcs[arcs_[arc_id].to].push_back(arc_id);
+            }
+            for (const ArcId arc_id : state.out_arcs[vertex]) {
+                neighbors.push_back(arcs_[arc_id].to);
+            }
+            for (const ArcId arc_id : state.in_arcs[vertex]) {
+                neighbors.push_back(arcs_[arc_id].from);
+            }
+        }
+        for (const VertexId vertex : round) {
+            state.in_round[vertex] = false;
+            state.out_arcs[vertex].clear();
+            state.out_arcs[vertex].shrink_to_fit();
+            state.in_arcs[vertex].clear();
+            state.in_arcs[vertex].shrink_to_fit();
+        }
+
+        std::sort(neighbors.begin(), neighbors.end());
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+        neighbors.erase(std::remove_if(neighbors.begin(), neighbors.end(), [&state](VertexId vertex) {
+            return state.contracted[vertex];
+        }), neighbors.end());
+        for (const VertexId vertex : neighbors) {
+            auto is_contracted_arc = [this, &state](ArcId arc_id) {
+                return state.contracted[arcs_[arc_id].from] || state.contracted[arcs_[arc_id].to];
+            };
+            auto& out_arcs = state.out_arcs[vertex];
+            auto& in_arcs = state.in_arcs[vertex];
+            const size_t arc_count = out_arcs.size() + in_arcs.size();
+            out_arcs.erase(std::remove_if(out_arcs.begin(), out_arcs.end(), is_contracted_arc), out_arcs.end());
+            in_arcs.erase(std::remove_if(in_arcs.begin(), in_arcs.end(), is_contracted_arc), in_arcs.end());
+            state.contracted_neighbors[vertex] += static_cast<int>(arc_count - out_arcs.size() - in_arcs.size());
+        }
+        for_each_parallel(neighbors, [&](size_t i, WitnessSearch& search) {
+            state.priority[neighbors[i]] = compute_priority(neighbors[i], search);
+        });
+
+        remaining = std::move(next_remaining);
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::BuildSearchGraph() {
+    const size_t vertex_count = rank_.size();
+    up_offsets_.assign(vertex_count + 1, 0);
+    down_offsets_.assign(vertex_count + 1, 0);
+    for (const Arc& arc : arcs_) {
+        if (rank_[arc.from] < rank_[arc.to]) {
+            ++up_offsets_[arc.from + 1];
+        } else {
+            ++down_offsets_[arc.to + 1];
+        }
+    }
+    for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+        up_offsets_[vertex + 1] += up_offsets_[vertex];
+        down_offsets_[vertex + 1] += down_offsets_[vertex];
+    }
+    up_arcs_.resize(up_offsets_.back());
+    down_arcs_.resize(down_offsets_.back());
+    std::vector<size_t> up_pos(up_offsets_.begin(), up_offsets_.end() - 1);
+    std::vector<size_t> down_pos(down_offsets_.begin(), down_offsets_.end() - 1);
+    for (ArcId arc_id = 0; arc_id < arcs_.size(); ++arc_id) {
+        const Arc& arc = arcs_[arc_id];
+        if (rank_[arc.from] < rank_[arc.to]) {
+            up_arcs_[up_pos[arc.from]++] = arc_id;
+        } else {
+            down_arcs_[down_pos[arc.to]++] = arc_id;
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<std::pair<Weight, VertexId>> ContractionHierarchy<Weight>::Search(VertexId from, VertexId to,
+                                                                                Labels& forward,
+                                                                                Labels& backward) const {
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+    Queue forward_queue;
+    Queue backward_queue;
+    forward[from] = Label{ZERO_WEIGHT, NO_ARC};
+    backward[to] = Label{ZERO_WEIGHT, NO_ARC};
+    forward_queue.push({ZERO_WEIGHT, from});
+    backward_queue.push({ZERO_WEIGHT, to});
+
+    std::optional<std::pair<Weight, VertexId>> best;
+    auto is_useful = [&best](const Queue& queue) {
+        return !queue.empty() && (!best || queue.top().first < best->first);
+    };
+
+    while (is_useful(forward_queue) || is_useful(backward_queue)) {
+        const bool is_forward = is_useful(forward_queue)
+            && (!is_useful(backward_queue) || forward_queue.top().first <= backward_queue.top().first);
+        Queue& queue = is_forward ? forward_queue : backward_queue;
+        Labels& labels = is_forward ? forward : backward;
+        const Labels& other_labels = is_forward ? backward : forward;
+
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (labels.at(vertex).weight < weight) {
+            continue;
+        }
+        if (auto other = other_labels.find(vertex); other != other_labels.end()) {
+            const Weight total_weight = weight + other->second.weight;
+            if (!best || total_weight < best->first) {
+                best = std::pair{total_weight, vertex};
+            }
+        }
+
+        const auto& offsets = is_forward ? up_offsets_ : down_offsets_;
+        const auto& search_arcs = is_forward ? up_arcs_ : down_arcs_;
+        for (size_t i = offsets[vertex]; i < offsets[vertex + 1]; ++i) {
+            const ArcId arc_id = search_arcs[i];
+            const Arc& arc = arcs_[arc_id];
+            const VertexId next = is_forward ? arc.to : arc.from;
+            const Weight candidate_weight = weight + arc.weight;
+            auto [it, inserted] = labels.try_emplace(next, Label{candidate_weight, arc_id});
+            if (inserted || candidate_weight < it->second.weight) {
+                it->second = Label{candidate_weight, arc_id};
+                queue.push({candidate_weight, next});
+            }
+        }
+    }
+    return best;
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::UnpackArc(ArcId arc_id, std::vector<EdgeId>& edges) const {
+    std::vector<ArcId> stack = {arc_id};
+    while (!stack.empty()) {
+        const Arc& arc = arcs_[stack.back()];
+        stack.pop_back();
+        if (arc.first == NO_ARC) {
+            edges.push_back(arc.edge);
+        } else {
+            stack.push_back(arc.second);
+            stack.push_back(arc.first);
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchy<Weight>::RouteInfo> ContractionHierarchy<Weight>::BuildRoute(
+    VertexId from, VertexId to) const {
+    Labels forward;
+    Labels backward;
+    const auto best = Search(from, to, forward, backward);
+    if (!best) {
+        return std::nullopt;
+    }
+    const VertexId meeting = best->second;
+
+    std::vector<ArcId> path;
+    for (ArcId arc_id = forward.at(meeting).arc; arc_id != NO_ARC; arc_id = forward.at(arcs_[arc_id].from).arc) {
+        path.push_back(arc_id);
+    }
+    std::reverse(path.begin(), path.end());
+    for (ArcId arc_id = backward.at(meeting).arc; arc_id != NO_ARC; arc_id = backward.at(arcs_[arc_id].to).arc) {
+        path.push_back(arc_id);
+    }
+
+    std::vector<EdgeId> edges;
+    for (const ArcId arc_id : path) {
+        UnpackArc(arc_id, edges);
+    }
+    return RouteInfo{best->first, std::move(edges)};
+}
+
+template <typename Weight>
+std::optional<Weight> ContractionHierarchy<Weight>::GetRouteWeight(VertexId from, VertexId to) const {
+    Labels forward;
+    Labels backward;
+    if (const auto best = Search(from, to, forward, backward)) {
+        return best->first;
+    }
+    return std::nullopt;
+}
+
+template <typename Weight>
+const typename ContractionHierarchy<Weight>::Stats& ContractionHierarchy<Weight>::GetStats() const {
+    return stats_;
+}
+
+}  // namespace graph
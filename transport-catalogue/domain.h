@@ -1,6 +1,8 @@
 #pragma once
 
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "geo.h"
@@ -10,8 +12,11 @@ namespace domain {
     using namespace geo;
 
     struct Stop {
-        std::string name;
+        // Имя хранится в справочнике, который сохраняет его при добавлении остановки
+        std::string_view name;
         Coordinates coordinates;
+        // Заполняется каталогом при добавлении остановки
+        SpherePoint sphere_point = {};
 
         bool operator<(const Stop& other) const {
             return name < other.name;
@@ -19,8 +24,10 @@ namespace domain {
     };
 
     struct Bus {
-        std::string name;
-        std::vector<const Stop*> stops;
+        // Имя хранится в справочнике, который сохраняет его при добавлении автобуса
+        std::string_view name;
+        // Память берётся из ресурса справочника, в который добавлен автобус
+        std::pmr::vector<const Stop*> stops;
         bool is_roundtrip;
     };
 
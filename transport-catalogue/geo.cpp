@@ -2,16 +2,48 @@
 
 #include "geo.h"
 
+#include <algorithm>
 #include <cmath>
 
 namespace geo {
 
+namespace {
+
+    const double EARTH_RADIUS = 6371000;
+    const double DEGREE = M_PI / 180.0;
+
+}  // namespace
+
     double ComputeDistance(Coordinates from, Coordinates to) {
         using namespace std;
-        const double dr = M_PI / 180.0;
+        const double dr = DEGREE;
         return acos(sin(from.lat * dr) * sin(to.lat * dr)
                 + cos(from.lat * dr) * cos(to.lat * dr) * cos(abs(from.lng - to.lng) * dr))
-        * 6371000;
+        * EARTH_RADIUS;
+    }
+
+    SpherePoint ToSpherePoint(Coordinates coordinates) {
+        using namespace std;
+        const double lat = coordinates.lat * DEGREE;
+        const double lng = coordinates.lng * DEGREE;
+        return {cos(lat) * cos(lng), cos(lat) * sin(lng), sin(lat)};
+    }
+
+    double ComputeDistance(const SpherePoint& from, const SpherePoint& to) {
+        double distance = 0.0;
+        ComputeDistances(&from, &to, &distance, 1);
+        return distance;
+    }
+
+    void ComputeDistances(const SpherePoint* from, const SpherePoint* to, double* distances, std::size_t count) {
+        // Скалярные произведения считаются отдельным циклом без ветвлений,
+        // который компилятор векторизует; acos применяется вторым проходом
+        for (std::size_t i = 0; i < count; ++i) {
+            distances[i] = from[i].x * to[i].x + from[i].y * to[i].y + from[i].z * to[i].z;
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            distances[i] = std::acos(std::clamp(distances[i], -1.0, 1.0)) * EARTH_RADIUS;
+        }
     }
 
 }  // namespace geo
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 
 namespace geo {
@@ -16,6 +17,13 @@ namespace geo {
         }
     };
 
+    // Точка единичной сферы, соответствующая географическим координатам
+    struct SpherePoint {
+        double x = 0.0;
+        double y = 0.0;
+        double z = 0.0;
+    };
+
     struct Distance {
         int distance;
         std::string stop_name;
@@ -23,4 +31,11 @@ namespace geo {
 
     double ComputeDistance(Coordinates from, Coordinates to);
 
+    SpherePoint ToSpherePoint(Coordinates coordinates);
+
+    double ComputeDistance(const SpherePoint& from, const SpherePoint& to);
+
+    // Записывает в distances[i] расстояние между from[i] и to[i] для всех i < count
+    void ComputeDistances(const SpherePoint* from, const SpherePoint* to, double* distances, std::size_t count);
+
 }  // namespace geo
\ No newline at end of file
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "ranges.h"
+#include "memory_usage.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <vector>
 
@@ -27,20 +29,31 @@ public:
     DirectedWeightedGraph() = default;
     explicit DirectedWeightedGraph(size_t vertex_count);
     EdgeId AddEdge(const Edge<Weight>& edge);
+    VertexId AddVertex();
+    // Исключает ребро из списка инцидентности; идентификаторы остальных рёбер не меняются
+    void RemoveEdge(EdgeId edge_id);
+    void SetEdgeWeight(EdgeId edge_id, Weight weight);
 
     size_t GetVertexCount() const;
     size_t GetEdgeCount() const;
     const Edge<Weight>& GetEdge(EdgeId edge_id) const;
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
+    // Рёбра, входящие в вершину
+    IncidentEdgesRange GetIncomingEdges(VertexId vertex) const;
+
+    // Память рёбер и списков инцидентности; число элементов списков - число записей в них
+    memory::Report GetMemoryReport() const;
 
 private:
     std::vector<Edge<Weight>> edges_;
     std::vector<IncidenceList> incidence_lists_;
+    std::vector<IncidenceList> incoming_lists_;
 };
 
 template <typename Weight>
 DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
-    : incidence_lists_(vertex_count) {
+    : incidence_lists_(vertex_count)
+    , incoming_lists_(vertex_count) {
 }
 
 template <typename Weight>
@@ -48,9 +61,32 @@ EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
     edges_.push_back(edge);
     const EdgeId id = edges_.size() - 1;
     incidence_lists_.at(edge.from).push_back(id);
+    incoming_lists_.at(edge.to).push_back(id);
     return id;
 }
 
+template <typename Weight>
+VertexId DirectedWeightedGraph<Weight>::AddVertex() {
+    incidence_lists_.emplace_back();
+    incoming_lists_.emplace_back();
+    return incidence_lists_.size() - 1;
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::RemoveEdge(EdgeId edge_id) {
+    auto& incidence_list = incidence_lists_.at(edges_.at(edge_id).from);
+    incidence_list.erase(std::remove(incidence_list.begin(), incidence_list.end(), edge_id),
+                         incidence_list.end());
+    auto& incoming_list = incoming_lists_.at(edges_.at(edge_id).to);
+    incoming_list.erase(std::remove(incoming_list.begin(), incoming_list.end(), edge_id),
+                        incoming_list.end());
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::SetEdgeWeight(EdgeId edge_id, Weight weight) {
+    edges_.at(edge_id).weight = weight;
+}
+
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
     return incidence_lists_.size();
@@ -71,4 +107,27 @@ typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
 DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
     return ranges::AsRange(incidence_lists_.at(vertex));
 }
+
+template <typename Weight>
+typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
+DirectedWeightedGraph<Weight>::GetIncomingEdges(VertexId vertex) const {
+    return ranges::AsRange(incoming_lists_.at(vertex));
+}
+
+template <typename Weight>
+memory::Report DirectedWeightedGraph<Weight>::GetMemoryReport() const {
+    auto get_lists_usage = [](std::string name, const std::vector<IncidenceList>& lists) {
+        memory::Usage usage{std::move(name), 0, memory::GetHeapBytes(lists)};
+        for (const IncidenceList& list : lists) {
+            usage.count += list.size();
+            usage.bytes += memory::GetHeapBytes(list);
+        }
+        return usage;
+    };
+    return {
+        {"edges", edges_.size(), memory::GetHeapBytes(edges_)},
+        get_lists_usage("incidence_lists", incidence_lists_),
+        get_lists_usage("incoming_lists", incoming_lists_)
+    };
+}
 }  // namespace graph
\ No newline at end of file
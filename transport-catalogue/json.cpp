@@ -1,6 +1,11 @@
 #include "json.h"
+#include "parallel.h"
 
+#include <charconv>
+#include <cstdint>
 #include <iterator>
+#include <limits>
+#include <sstream>
 
 namespace json {
 
@@ -20,22 +25,30 @@ namespace {
         return s;
     }
 
-    Node LoadArray(std::istream& input) {
-        std::vector<Node> result;
-
+    template <typename OnItem>
+    void LoadArrayItems(std::istream& input, OnItem on_item) {
         for (char c; input >> c && c != ']';) {
             if (c != ',') {
                 input.putback(c);
             }
-            result.push_back(LoadNode(input));
+            on_item(LoadNode(input));
         }
         if (!input) {
             throw ParsingError("Array parsing error"s);
         }
+    }
+
+    Node LoadArray(std::istream& input) {
+        std::vector<Node> result;
+        LoadArrayItems(input, [&result](Node item) {
+            result.push_back(std::move(item));
+        });
         return Node(std::move(result));
     }
 
-    Node LoadDict(std::istream& input) {
+    // load_value(input, key) разбирает значение по ключу
+    template <typename LoadValue>
+    Node LoadDict(std::istream& input, LoadValue load_value) {
         Dict dict;
 
         for (char c; input >> c && c != '}';) {
@@ -45,7 +58,8 @@ namespace {
                     if (dict.find(key) != dict.end()) {
                         throw ParsingError("Duplicate key '"s + key + "' have been found");
                     }
-                    dict.emplace(std::move(key), LoadNode(input));
+                    Node value = load_value(input, key);
+                    dict.emplace(std::move(key), std::move(value));
                 } else {
                     throw ParsingError(": is expected but '"s + c + "' has been found"s);
                 }
@@ -59,6 +73,12 @@ namespace {
         return Node(std::move(dict));
     }
 
+    Node LoadDict(std::istream& input) {
+        return LoadDict(input, [](std::istream& stream, const std::string&) {
+            return LoadNode(stream);
+        });
+    }
+
     Node LoadString(std::istream& input) {
         auto it = std::istreambuf_iterator<char>(input);
         auto end = std::istreambuf_iterator<char>();
@@ -211,6 +231,384 @@ namespace {
         }
     }
 
+    // Двухэтапный разбор. На первом этапе текст делится на куски, и в каждом параллельно
+    // находятся структурные символы вне строк: скобки, запятые, двоеточия, открывающие кавычки
+    // и начала чисел и литералов. На втором этапе дерево строится по этим позициям, а элементы
+    // больших массивов разбираются в нескольких потоках
+    using StructuralIndex = std::vector<std::uint32_t>;
+
+    constexpr std::size_t MIN_CHUNK_SIZE = 1 << 16;
+    constexpr std::size_t CHUNKS_PER_THREAD = 4;
+    // Меньшие массивы разбираются в одном потоке
+    constexpr std::size_t MIN_PARALLEL_ARRAY_SIZE = 64;
+
+    bool IsWhitespace(char c) {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    bool IsStructural(char c) {
+        return c == '{' || c == '}' || c == '[' || c == ']' || c == ',' || c == ':';
+    }
+
+    // Часть числа или литерала вне строки
+    bool IsScalarChar(char c) {
+        return !IsWhitespace(c) && !IsStructural(c) && c != '"';
+    }
+
+    // Экранирован ли символ в позиции pos: перед ним нечётное число обратных косых черт
+    bool IsEscaped(std::string_view text, std::size_t pos) {
+        std::size_t backslashes = 0;
+        while (pos > backslashes && text[pos - backslashes - 1] == '\\') {
+            ++backslashes;
+        }
+        return backslashes % 2 == 1;
+    }
+
+    // Число неэкранированных кавычек в [begin, end), по его чётности находится состояние следующего куска
+    bool HasOddQuotes(std::string_view text, std::size_t begin, std::size_t end) {
+        bool is_odd = false;
+        bool is_escaped = IsEscaped(text, begin);
+        for (std::size_t i = begin; i < end; ++i) {
+            const char c = text[i];
+            if (is_escaped) {
+                is_escaped = false;
+            } else if (c == '\\') {
+                is_escaped = true;
+            } else if (c == '"') {
+                is_odd = !is_odd;
+            }
+        }
+        return is_odd;
+    }
+
+    void IndexChunk(std::string_view text, std::size_t begin, std::size_t end, bool in_string, StructuralIndex& index) {
+        bool is_escaped = IsEscaped(text, begin);
+        bool after_scalar = begin > 0 && !in_string && IsScalarChar(text[begin - 1]);
+        for (std::size_t i = begin; i < end; ++i) {
+            const char c = text[i];
+            if (in_string) {
+                if (is_escaped) {
+                    is_escaped = false;
+                } else if (c == '\\') {
+                    is_escaped = true;
+                } else if (c == '"') {
+                    in_string = false;
+                }
+                after_scalar = false;
+                continue;
+            }
+            const bool is_scalar = IsScalarChar(c);
+            if (c == '"' && !is_escaped) {
+                in_string = true;
+                index.push_back(static_cast<std::uint32_t>(i));
+            } else if (IsStructural(c) || (is_scalar && !after_scalar)) {
+                index.push_back(static_cast<std::uint32_t>(i));
+            }
+            is_escaped = !is_escaped && c == '\\';
+            after_scalar = is_scalar;
+        }
+    }
+
+    StructuralIndex BuildStructuralIndex(std::string_view text, std::size_t thread_count) {
+        if (text.size() > std::numeric_limits<std::uint32_t>::max()) {
+            throw ParsingError("Document is too large"s);
+        }
+        const std::size_t chunk_count = std::clamp<std::size_t>(
+            text.size() / MIN_CHUNK_SIZE, 1, thread_count * CHUNKS_PER_THREAD);
+        const std::size_t chunk_size = text.size() / chunk_count + 1;
+        auto chunk_begin = [&](std::size_t chunk) {
+            return std::min(chunk * chunk_size, text.size());
+        };
+
+        std::vector<char> has_odd_quotes(chunk_count);
+        parallel::ParallelFor(chunk_count, [&](std::size_t chunk) {
+            has_odd_quotes[chunk] = HasOddQuotes(text, chunk_begin(chunk), chunk_begin(chunk + 1));
+        }, thread_count);
+
+        std::vector<char> in_string(chunk_count, false);
+        for (std::size_t chunk = 1; chunk < chunk_count; ++chunk) {
+            in_string[chunk] = in_string[chunk - 1] != has_odd_quotes[chunk - 1];
+        }
+
+        std::vector<StructuralIndex> chunk_indices(chunk_count);
+        parallel::ParallelFor(chunk_count, [&](std::size_t chunk) {
+            IndexChunk(text, chunk_begin(chunk), chunk_begin(chunk + 1), in_string[chunk], chunk_indices[chunk]);
+        }, thread_count);
+
+        StructuralIndex index;
+        std::size_t size = 0;
+        for (const auto& chunk_index : chunk_indices) {
+            size += chunk_index.size();
+        }
+        index.reserve(size);
+        for (const auto& chunk_index : chunk_indices) {
+            index.insert(index.end(), chunk_index.begin(), chunk_index.end());
+        }
+        return index;
+    }
+
+    class IndexedParser {
+    public:
+        IndexedParser(std::string_view text, const StructuralIndex& index, std::size_t thread_count) :
+            text_(text), index_(index), thread_count_(thread_count)
+        {}
+
+        Node ParseDocument() const {
+            std::size_t pos = 0;
+            Node root = ParseValue(pos, thread_count_ > 1);
+            if (pos != index_.size()) {
+                throw ParsingError("Unexpected data after the document"s);
+            }
+            return root;
+        }
+
+    private:
+        std::string_view text_;
+        const StructuralIndex& index_;
+        std::size_t thread_count_;
+
+        char GetChar(std::size_t pos) const {
+            if (pos >= index_.size()) {
+                throw ParsingError("Unexpected EOF"s);
+            }
+            return text_[index_[pos]];
+        }
+
+        // Разбирает значение, начинающееся в позиции индекса pos, и сдвигает pos за него
+        Node ParseValue(std::size_t& pos, bool is_parallel) const {
+            const char c = GetChar(pos);
+            switch (c) {
+                case '[':
+                    return is_parallel ? ParseArrayParallel(pos) : ParseArray(pos);
+                case '{':
+                    return ParseDict(pos, is_parallel);
+                case '"':
+                    return Node(ParseString(pos));
+                case ']':
+                    [[fallthrough]];
+                case '}':
+                    [[fallthrough]];
+                case ',':
+                    [[fallthrough]];
+                case ':':
+                    throw ParsingError("Unexpected '"s + c + "'"s);
+                default:
+                    return ParseScalar(pos);
+            }
+        }
+
+        Node ParseArray(std::size_t& pos) const {
+            Array result;
+            if (GetChar(++pos) == ']') {
+                ++pos;
+                return Node(std::move(result));
+            }
+            while (true) {
+                result.push_back(ParseValue(pos, false));
+                const char c = GetChar(pos++);
+                if (c == ']') {
+                    break;
+                }
+                if (c != ',') {
+                    throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+                }
+            }
+            return Node(std::move(result));
+        }
+
+        // Находит начала элементов, перескакивая вложенные значения по глубине скобок,
+        // и разбирает элементы независимо друг от друга
+        Node ParseArrayParallel(std::size_t& pos) const {
+            std::vector<std::size_t> starts;
+            std::size_t depth = 0;
+            std::size_t end = pos + 1;
+            for (;; ++end) {
+                const char c = GetChar(end);
+                if (c == '[' || c == '{') {
+                    if (depth++ == 0) {
+                        starts.push_back(end);
+                    }
+                } else if (c == ']' || c == '}') {
+                    if (depth == 0) {
+                        break;
+                    }
+                    --depth;
+                } else if (depth == 0 && c != ',') {
+                    starts.push_back(end);
+                }
+            }
+            if (starts.size() < MIN_PARALLEL_ARRAY_SIZE) {
+                return ParseArray(pos);
+            }
+
+            Array result(starts.size());
+            parallel::ParallelFor(starts.size(), [&](std::size_t i) {
+                std::size_t item_pos = starts[i];
+                result[i] = ParseValue(item_pos, false);
+                const bool is_last = i + 1 == starts.size();
+                const char c = GetChar(item_pos);
+                if (is_last ? c != ']' || item_pos != end : c != ',' || item_pos + 1 != starts[i + 1]) {
+                    throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+                }
+            }, thread_count_);
+            if (GetChar(end) != ']') {
+                throw ParsingError("Array parsing error"s);
+            }
+            pos = end + 1;
+            return Node(std::move(result));
+        }
+
+        Node ParseDict(std::size_t& pos, bool is_parallel) const {
+            Dict dict;
+            if (GetChar(++pos) == '}') {
+                ++pos;
+                return Node(std::move(dict));
+            }
+            while (true) {
+                if (GetChar(pos) != '"') {
+                    throw ParsingError("Dictionary key is expected but '"s + GetChar(pos) + "' has been found"s);
+                }
+                std::string key = ParseString(pos);
+                if (const char c = GetChar(pos++); c != ':') {
+                    throw ParsingError(": is expected but '"s + c + "' has been found"s);
+                }
+                if (dict.find(key) != dict.end()) {
+                    throw ParsingError("Duplicate key '"s + key + "' have been found");
+                }
+                Node value = ParseValue(pos, is_parallel);
+                dict.emplace(std::move(key), std::move(value));
+                const char c = GetChar(pos++);
+                if (c == '}') {
+                    break;
+                }
+                if (c != ',') {
+                    throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+                }
+            }
+            return Node(std::move(dict));
+        }
+
+        // Закрывающая кавычка не попадает в индекс, поэтому строка дочитывается по тексту
+        std::string ParseString(std::size_t& pos) const {
+            std::string s;
+            std::size_t i = index_[pos++] + 1;
+            while (true) {
+                if (i >= text_.size()) {
+                    throw ParsingError("String parsing error");
+                }
+                const char ch = text_[i++];
+                if (ch == '"') {
+                    break;
+                } else if (ch == '\\') {
+                    if (i >= text_.size()) {
+                        throw ParsingError("String parsing error");
+                    }
+                    const char escaped_char = text_[i++];
+                    switch (escaped_char) {
+                        case 'n':
+                            s.push_back('\n');
+                            break;
+                        case 't':
+                            s.push_back('\t');
+                            break;
+                        case 'r':
+                            s.push_back('\r');
+                            break;
+                        case '"':
+                            s.push_back('"');
+                            break;
+                        case '\\':
+                            s.push_back('\\');
+                            break;
+                        default:
+                            throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
+                    }
+                } else if (ch == '\n' || ch == '\r') {
+                    throw ParsingError("Unexpected end of line"s);
+                } else {
+                    s.push_back(ch);
+                }
+            }
+            return s;
+        }
+
+        // Число или литерал занимает текст до следующего структурного символа
+        Node ParseScalar(std::size_t& pos) const {
+            const std::size_t begin = index_[pos++];
+            std::size_t end = begin;
+            while (end < text_.size() && IsScalarChar(text_[end])) {
+                ++end;
+            }
+            const std::string_view token = text_.substr(begin, end - begin);
+            if (token == "true"sv) {
+                return Node{true};
+            } else if (token == "false"sv) {
+                return Node{false};
+            } else if (token == "null"sv) {
+                return Node{nullptr};
+            }
+            return ParseNumber(token);
+        }
+
+        static Node ParseNumber(std::string_view token) {
+            std::size_t i = 0;
+            auto is_digit = [&token](std::size_t i) {
+                return i < token.size() && std::isdigit(static_cast<unsigned char>(token[i]));
+            };
+            auto read_digits = [&] {
+                if (!is_digit(i)) {
+                    throw ParsingError("A digit is expected"s);
+                }
+                while (is_digit(i)) {
+                    ++i;
+                }
+            };
+
+            if (i < token.size() && token[i] == '-') {
+                ++i;
+            }
+            if (i < token.size() && token[i] == '0') {
+                ++i;
+            } else {
+                read_digits();
+            }
+
+            bool is_int = true;
+            if (i < token.size() && token[i] == '.') {
+                ++i;
+                read_digits();
+                is_int = false;
+            }
+
+            if (i < token.size() && (token[i] == 'e' || token[i] == 'E')) {
+                ++i;
+                if (i < token.size() && (token[i] == '+' || token[i] == '-')) {
+                    ++i;
+                }
+                read_digits();
+                is_int = false;
+            }
+            if (i != token.size()) {
+                throw ParsingError("Failed to parse '"s + std::string(token) + "' as number"s);
+            }
+
+            const char* first = token.data();
+            const char* last = token.data() + token.size();
+            if (is_int) {
+                int value;
+                // При переполнении число разбирается как double
+                if (auto [ptr, ec] = std::from_chars(first, last, value); ec == std::errc{}) {
+                    return value;
+                }
+            }
+            double value;
+            if (auto [ptr, ec] = std::from_chars(first, last, value); ec != std::errc{}) {
+                throw ParsingError("Failed to convert "s + std::string(token) + " to number"s);
+            }
+            return value;
+        }
+    };
+
     struct PrintContext {
         std::ostream& out;
         int indent_step = 4;
@@ -331,6 +729,36 @@ namespace {
         return Document{LoadNode(input)};
     }
 
+    Document LoadStreaming(std::istream& input, const std::string& stream_key, const std::function<void(Node)>& on_item) {
+        char c;
+        if (!(input >> c) || c != '{') {
+            throw ParsingError("Dictionary is expected at the root"s);
+        }
+        return Document{LoadDict(input, [&stream_key, &on_item](std::istream& stream, const std::string& key) {
+            if (key != stream_key) {
+                return LoadNode(stream);
+            }
+            char bracket;
+            if (!(stream >> bracket) || bracket != '[') {
+                throw ParsingError("Array is expected for key '"s + key + "'"s);
+            }
+            LoadArrayItems(stream, on_item);
+            return Node(Array{});
+        })};
+    }
+
+    Document LoadParallel(std::string_view text, std::size_t thread_count) {
+        thread_count = std::max<std::size_t>(thread_count, 1);
+        const StructuralIndex index = BuildStructuralIndex(text, thread_count);
+        return Document{IndexedParser(text, index, thread_count).ParseDocument()};
+    }
+
+    Document LoadParallel(std::istream& input) {
+        std::ostringstream text;
+        text << input.rdbuf();
+        return LoadParallel(text.str(), parallel::GetThreadCount());
+    }
+
     void Print(const Document& doc, std::ostream& output) {
         PrintNode(doc.GetRoot(), PrintContext{output});
     }
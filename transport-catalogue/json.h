@@ -1,8 +1,10 @@
 #pragma once
 
+#include <functional>
 #include <iostream>
 #include <map>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -158,6 +160,19 @@ namespace json {
 
     Document Load(std::istream& input);
 
+    // Разбирает документ со словарём в корне. Элементы массива по ключу stream_key передаются
+    // в on_item по мере разбора и в документ не попадают: по этому ключу остаётся пустой массив
+    Document LoadStreaming(std::istream& input, const std::string& stream_key, const std::function<void(Node)>& on_item);
+
+    // Разбирает весь текст в два этапа: сначала параллельно по кускам строится индекс
+    // структурных символов, затем по нему строится дерево, и элементы больших массивов
+    // разбираются в thread_count потоках. Принимается только корректный JSON: в отличие от Load,
+    // пропущенная запятая между элементами ([1 2]) и данные после корня ({"a":1}}) дают ParsingError,
+    // пробелы после документа допускаются
+    Document LoadParallel(std::string_view text, std::size_t thread_count);
+    // Читает поток до конца и разбирает его во всех доступных потоках
+    Document LoadParallel(std::istream& input);
+
     void Print(const Document& doc, std::ostream& output);
 
 }  // namespace json
\ No newline at end of file
@@ -1,7 +1,18 @@
 #include "json_reader.h"
+#include "metrics.h"
+#include "parallel.h"
+#include "trace.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <limits>
 #include <string>
 #include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 
 namespace json_reader {
@@ -34,10 +45,270 @@ namespace {
         return res.str();
     }
 
+    transport_router::RouteEngine GetRouteEngine(const std::string& name) {
+        if (name == "all_pairs") {
+            return transport_router::RouteEngine::ALL_PAIRS;
+        } else if (name == "dijkstra") {
+            return transport_router::RouteEngine::DIJKSTRA;
+        } else if (name == "contraction_hierarchies") {
+            return transport_router::RouteEngine::CONTRACTION_HIERARCHIES;
+        } else if (name == "a_star") {
+            return transport_router::RouteEngine::A_STAR;
+        } else if (name == "bidirectional") {
+            return transport_router::RouteEngine::BIDIRECTIONAL;
+        } else if (name == "raptor") {
+            return transport_router::RouteEngine::RAPTOR;
+        }
+        throw std::invalid_argument("Unknown routing engine "s + name);
+    }
+
+    // Ограничение числа пересадок для запроса Парето-оптимальных маршрутов по умолчанию
+    constexpr int DEFAULT_MAX_TRANSFERS = 5;
+
+    // Число остановок в ответе на запрос StopSearch по умолчанию
+    constexpr int DEFAULT_STOP_SEARCH_LIMIT = 10;
+
+    std::vector<std::string_view> GetStopNames(const json::Array& names) {
+        std::vector<std::string_view> result;
+        result.reserve(names.size());
+        for (const auto& name : names) {
+            result.push_back(name.AsString());
+        }
+        return result;
+    }
+
+    // Разбор строже json::Load: пропущенные запятые и данные после документа - ошибка
+    json::Document LoadDocument(std::istream& input) {
+        static auto& load_time = metrics::GetPhaseHistogram("json_load");
+        metrics::ScopedTimer timer(load_time);
+        trace::Span span("json_load", "ingest");
+        return json::LoadParallel(input);
+    }
+
+    // Остановки автобуса в порядке проезда: некольцевой маршрут проходится туда и обратно
+    std::pmr::vector<const Stop*> GetBusStops(const json::Dict& description, const TransportCatalogue& catalogue) {
+        const auto& route = description.at("stops").AsArray();
+        std::pmr::vector<const Stop*> stops;
+        for (const auto& stop : route) {
+            stops.push_back(catalogue.FindStop(stop.AsString()));
+        }
+        if (!description.at("is_roundtrip").AsBool() && route.size() > 1) {
+            for (auto it = route.rbegin() + 1; it != route.rend(); ++it) {
+                const auto& stop = *it;
+                stops.push_back(catalogue.FindStop(stop.AsString()));
+            }
+        }
+        return stops;
+    }
+
+    // Наполняет справочник командами в порядке их разбора. Расстояние до ещё не добавленной
+    // остановки откладывается до её появления. Автобус ждёт, пока появятся все его остановки,
+    // а следующие за ним ждут его, чтобы автобусы добавлялись в том же порядке, что и в ApplyCommands
+    class PipelineBuilder {
+    public:
+        PipelineBuilder(TransportCatalogue& catalogue, transport_router::TransportRouter& router) :
+            catalogue_(catalogue), router_(router)
+        {}
+
+        void Handle(json::Node command) {
+            const auto& type = command.AsMap().at("type").AsString();
+            if (type == "Stop") {
+                AddStop(command.AsMap());
+                AddReadyBuses();
+            } else if (type == "Bus") {
+                pending_buses_.push_back({std::move(command), 0});
+                AddReadyBuses();
+            }
+        }
+
+        // Добавляет всё отложенное, даже если остановки так и не появились
+        void Finish() {
+            for (const auto& [name, distances] : pending_distances_) {
+                for (const auto& [from, distance] : distances) {
+                    catalogue_.SetDistanceBetweenStops(from, catalogue_.FindStop(name), distance);
+                }
+            }
+            pending_distances_.clear();
+            for (const auto& bus : pending_buses_) {
+                AddBus(bus.command.AsMap());
+            }
+            pending_buses_.clear();
+        }
+
+    private:
+        struct PendingBus {
+            json::Node command;
+            // Число первых остановок маршрута, которые уже есть в справочнике
+            std::size_t known_stops;
+        };
+
+        TransportCatalogue& catalogue_;
+        transport_router::TransportRouter& router_;
+        std::unordered_map<std::string, std::vector<std::pair<const Stop*, int>>> pending_distances_;
+        std::deque<PendingBus> pending_buses_;
+
+        void AddStop(const json::Dict& description) {
+            const auto& name = description.at("name").AsString();
+            catalogue_.AddStop({name, Coordinates{description.at("latitude").AsDouble(),
+                                                  description.at("longitude").AsDouble()}});
+            const Stop* stop = catalogue_.FindStop(name);
+            router_.PrepareStop(*stop);
+            for (const auto& [to_name, distance] : description.at("road_distances").AsMap()) {
+                if (const Stop* to = catalogue_.FindStop(to_name)) {
+                    catalogue_.SetDistanceBetweenStops(stop, to, distance.AsInt());
+                } else {
+                    pending_distances_[to_name].push_back({stop, distance.AsInt()});
+                }
+            }
+            if (auto pending = pending_distances_.find(name); pending != pending_distances_.end()) {
+                for (const auto& [from, distance] : pending->second) {
+                    catalogue_.SetDistanceBetweenStops(from, stop, distance);
+                }
+                pending_distances_.erase(pending);
+            }
+        }
+
+        void AddReadyBuses() {
+            while (!pending_buses_.empty()) {
+                PendingBus& bus = pending_buses_.front();
+                const auto& route = bus.command.AsMap().at("stops").AsArray();
+                while (bus.known_stops < route.size()
+                       && catalogue_.FindStop(route[bus.known_stops].AsString()) != nullptr) {
+                    ++bus.known_stops;
+                }
+                if (bus.known_stops < route.size()) {
+                    return;
+                }
+                AddBus(bus.command.AsMap());
+                pending_buses_.pop_front();
+            }
+        }
+
+        // Все остановки автобуса и расстояния между ними уже известны, поэтому его рёбра
+        // добавляются в граф маршрутизатора сразу, пока разбор продолжается
+        void AddBus(const json::Dict& description) {
+            const auto& name = description.at("name").AsString();
+            catalogue_.AddBus({name, GetBusStops(description, catalogue_), description.at("is_roundtrip").AsBool()});
+            router_.PrepareBus(*catalogue_.FindBus(name));
+        }
+    };
+
+    // Разбор и наполнение справочника в двух потоках: команды из base_requests передаются
+    // пачками через ограниченную очередь, пока разбирается остальной документ
+    json::Document LoadPipelined(std::istream& input, TransportCatalogue& catalogue,
+                                 transport_router::TransportRouter& router) {
+        static auto& load_time = metrics::GetPhaseHistogram("json_load");
+        static auto& apply_time = metrics::GetPhaseHistogram("apply_commands");
+        static auto& base_requests = metrics::GetCounter("base_requests");
+        constexpr std::size_t BATCH_SIZE = 256;
+        constexpr std::size_t QUEUE_CAPACITY = 64;
+
+        parallel::BoundedQueue<json::Array> queue(QUEUE_CAPACITY);
+        std::exception_ptr build_error;
+        std::thread builder_thread([&]() {
+            metrics::ScopedTimer timer(apply_time);
+            trace::Span span("ApplyCommands", "ingest");
+            try {
+                PipelineBuilder builder(catalogue, router);
+                while (auto batch = queue.Pop()) {
+                    base_requests.Add(batch->size());
+                    for (auto& command : *batch) {
+                        builder.Handle(std::move(command));
+                    }
+                }
+                builder.Finish();
+            } catch (...) {
+                build_error = std::current_exception();
+                queue.Close();
+            }
+        });
+
+        std::optional<json::Document> document;
+        try {
+            metrics::ScopedTimer timer(load_time);
+            trace::Span span("json_load", "ingest");
+            json::Array batch;
+            document = json::LoadStreaming(input, "base_requests", [&queue, &batch](json::Node command) {
+                batch.push_back(std::move(command));
+                if (batch.size() == BATCH_SIZE) {
+                    queue.Push(std::move(batch));
+                    batch.clear();
+                }
+            });
+            queue.Push(std::move(batch));
+        } catch (...) {
+            queue.Close();
+            builder_thread.join();
+            throw;
+        }
+        queue.Close();
+        builder_thread.join();
+        if (build_error) {
+            std::rethrow_exception(build_error);
+        }
+        return std::move(*document);
+    }
+
+    // Счётчики обычно помещаются в int, иначе печатаются как double
+    json::Node CountNode(std::uint64_t value) {
+        if (value <= static_cast<std::uint64_t>(std::numeric_limits<int>::max())) {
+            return static_cast<int>(value);
+        }
+        return static_cast<double>(value);
+    }
+
+    // Число узлов документа и память строк, массивов и узлов словарей под ними.
+    // Сам узел учитывается в памяти содержащего его контейнера
+    void AddNodeUsage(const json::Node& node, memory::Usage& usage) {
+        ++usage.count;
+        if (node.IsString()) {
+            usage.bytes += memory::GetHeapBytes(node.AsString());
+        } else if (node.IsArray()) {
+            const auto& array = node.AsArray();
+            usage.bytes += memory::GetHeapBytes(array);
+            for (const auto& child : array) {
+                AddNodeUsage(child, usage);
+            }
+        } else if (node.IsMap()) {
+            const auto& dict = node.AsMap();
+            usage.bytes += memory::GetTreeBytes(dict);
+            for (const auto& [key, child] : dict) {
+                usage.bytes += memory::GetHeapBytes(key);
+                AddNodeUsage(child, usage);
+            }
+        }
+    }
+
+    void PrintHistograms(json::Builder& builder, const std::vector<std::pair<std::string, metrics::HistogramSummary>>& histograms) {
+        builder.StartDict();
+        for (const auto& [name, summary] : histograms) {
+            builder.Key(name).StartDict()
+                        .Key("count").Value(CountNode(summary.count))
+                        .Key("total_ms").Value(summary.total_ms)
+                        .Key("mean_us").Value(summary.mean_us)
+                        .Key("p50_us").Value(summary.p50_us)
+                        .Key("p90_us").Value(summary.p90_us)
+                        .Key("p99_us").Value(summary.p99_us)
+                        .Key("max_us").Value(summary.max_us)
+                    .EndDict();
+        }
+        builder.EndDict();
+    }
+
 }  // namespace
 
     JsonReader::JsonReader (std::istream& input) :
-        doc_(json::Load(input))
+        doc_(LoadDocument(input))
+    {
+        const auto& root = doc_.GetRoot().AsMap();
+        request_commands_ = &root.at("base_requests").AsArray();
+        stat_commands_ = &root.at("stat_requests").AsArray();
+        render_settings_ = &root.at("render_settings").AsMap();
+        route_settings_ = &root.at("routing_settings").AsMap();
+    }
+
+    JsonReader::JsonReader(std::istream& input, TransportCatalogue& catalogue, transport_router::TransportRouter& router) :
+        doc_(LoadPipelined(input, catalogue, router))
     {
         const auto& root = doc_.GetRoot().AsMap();
         request_commands_ = &root.at("base_requests").AsArray();
@@ -47,6 +318,12 @@ namespace {
     }
 
     void JsonReader::ApplyCommands(TransportCatalogue& catalogue) const {
+        static auto& apply_time = metrics::GetPhaseHistogram("apply_commands");
+        static auto& base_requests = metrics::GetCounter("base_requests");
+        metrics::ScopedTimer timer(apply_time);
+        trace::Span span("ApplyCommands", "ingest");
+        base_requests.Add(request_commands_->size());
+
         json::Array only_stop_commands;
         json::Array only_bus_commands;
 
@@ -56,6 +333,7 @@ namespace {
     }
 
     void JsonReader::CommandDistribution(json::Array& only_stop_commands, json::Array& only_bus_commands, TransportCatalogue& catalogue) const {
+        trace::Span span("CommandDistribution", "ingest");
         for (const auto& command : *request_commands_) {
             const auto& description = command.AsMap();
             const auto& type = description.at("type").AsString();
@@ -71,6 +349,7 @@ namespace {
     }
 
     void JsonReader::StopsHandle(json::Array& only_stop_commands, TransportCatalogue& catalogue) const {
+        trace::Span span("StopsHandle", "ingest");
         for (const auto& command : only_stop_commands) {
             const auto& description = command.AsMap();
             const auto& name = description.at("name").AsString();
@@ -86,27 +365,19 @@ namespace {
     }
 
     void JsonReader::BusesHandle(json::Array& only_bus_commands, TransportCatalogue& catalogue) const {
+        trace::Span span("BusesHandle", "ingest");
         for (const auto& command : only_bus_commands) {
             const auto& description = command.AsMap();
-            const auto& route = description.at("stops").AsArray();
-            std::vector<const Stop*> stops;
-            for (const auto& stop : route) {
-                stops.push_back(catalogue.FindStop(stop.AsString()));
-            }
-            bool is_roundtrip = description.at("is_roundtrip").AsBool();
-            if (!is_roundtrip && route.size() > 1) {
-                for (auto it = route.rbegin() + 1; it != route.rend(); ++it) {
-                    const auto& stop = *it;
-                    stops.push_back(catalogue.FindStop(stop.AsString()));
-                }
-            }
             catalogue.AddBus({description.at("name").AsString(),
-                              std::move(stops),
-                              is_roundtrip});
+                              GetBusStops(description, catalogue),
+                              description.at("is_roundtrip").AsBool()});
         }
     }
 
     void JsonReader::ApplyRenderSettingsCommands(renderer::MapRenderer& renderer) const {
+        static auto& apply_time = metrics::GetPhaseHistogram("render_settings");
+        metrics::ScopedTimer timer(apply_time);
+        trace::Span span("ApplyRenderSettingsCommands", "ingest");
         renderer::RenderSettings settings;
         for (const auto& [key, value] : *render_settings_) {
             if (key == "width") {
@@ -144,24 +415,39 @@ namespace {
                 for (const auto& color : colors) {
                     settings.color_palette.push_back(GetColor(color));
                 }
+            } else if (key == "simplify_tolerance") {
+                settings.simplify_tolerance = value.AsDouble();
+            } else if (key == "compact_output") {
+                settings.compact_output = value.AsBool();
+            } else if (key == "render_threads") {
+                settings.render_threads = static_cast<std::size_t>(std::max(value.AsInt(), 0));
             }
         }
         renderer.SetSettings(std::move(settings));
     }
 
     void JsonReader::ApplyRouteSettingsCommands(transport_router::TransportRouter& router) const {
+        trace::Span span("ApplyRouteSettingsCommands", "ingest");
         transport_router::RouteSettings settings;
         for (const auto& [key, value] : *route_settings_) {
             if (key == "bus_velocity") {
                 settings.bus_velocity = value.AsDouble();
             } else if (key == "bus_wait_time") {
                 settings.bus_wait_time = value.AsDouble();
+            } else if (key == "engine") {
+                settings.engine = GetRouteEngine(value.AsString());
+            } else if (key == "tree_cache_mb") {
+                settings.tree_cache_bytes = static_cast<std::size_t>(value.AsDouble() * (1 << 20));
             }
         }
         router.SetSettingsAndBuild(std::move(settings));
     }
 
     void JsonReader::PrintJson(const RequestHandler& request_handler, std::ostream& out) const {
+        static auto& print_time = metrics::GetPhaseHistogram("json_print");
+        static auto& stat_requests = metrics::GetCounter("stat_requests");
+        stat_requests.Add(stat_commands_->size());
+
         json::Builder builder;
         builder.StartArray();
         for (const auto& command : *stat_commands_) {
@@ -173,25 +459,137 @@ namespace {
             } else if (type == "Stop") {
                 const auto& stop_info = request_handler.GetBusesByStop(description.at("name").AsString());
                 PrintStopInfo(builder, stop_info, description.at("id").AsInt());
+            } else if (type == "StopSearch") {
+                const auto limit = description.count("limit") > 0
+                    ? description.at("limit").AsInt()
+                    : DEFAULT_STOP_SEARCH_LIMIT;
+                const auto& stops = request_handler.SearchStops(
+                    description.at("prefix").AsString(),
+                    static_cast<std::size_t>(std::max(limit, 0))
+                );
+                PrintStopSearch(builder, stops, description.at("id").AsInt());
             } else if (type == "Map") {
                 std::ostringstream map_out;
-                request_handler.RenderMap().Render(map_out);
+                const svg::Document map = request_handler.RenderMap();
+                trace::Span span("map.svg_text", "request");
+                map.Render(map_out);
                 builder.StartDict()
                             .Key("map").Value(map_out.str())
                             .Key("request_id").Value(description.at("id").AsInt())
                         .EndDict();
+            } else if (type == "Route" && description.count("pareto") > 0 && description.at("pareto").AsBool()) {
+                const auto max_transfers = description.count("max_transfers") > 0
+                    ? description.at("max_transfers").AsInt()
+                    : DEFAULT_MAX_TRANSFERS;
+                const auto& routes = request_handler.GetParetoRoutes(
+                    description.at("from").AsString(),
+                    description.at("to").AsString(),
+                    static_cast<std::size_t>(std::max(max_transfers, 0))
+                );
+                PrintParetoRoutes(builder, routes, description.at("id").AsInt());
+            } else if (type == "Route" && description.count("alternatives") > 0) {
+                const auto& alternatives = request_handler.GetRouteAlternatives(
+                    description.at("from").AsString(),
+                    description.at("to").AsString(),
+                    static_cast<std::size_t>(std::max(description.at("alternatives").AsInt(), 1))
+                );
+                PrintRouteAlternatives(builder, alternatives, description.at("id").AsInt());
             } else if (type == "Route") {
                 const auto& route_info = request_handler.GetRouteInfo(
                     description.at("from").AsString(),
                     description.at("to").AsString()
                 );
                 PrintRouteInfo(builder, route_info, description.at("id").AsInt());
+            } else if (type == "RouteMatrix") {
+                const auto& route_matrix = request_handler.GetRouteMatrix(
+                    GetStopNames(description.at("from").AsArray()),
+                    GetStopNames(description.at("to").AsArray())
+                );
+                PrintRouteMatrix(builder, route_matrix, description.at("id").AsInt());
+            } else if (type == "Isochrone") {
+                const auto& stops = request_handler.GetIsochrone(
+                    description.at("from").AsString(),
+                    description.at("max_time").AsDouble()
+                );
+                PrintIsochrone(builder, stops, description.at("id").AsInt());
+            } else if (type == "MemoryReport") {
+                PrintMemoryReport(builder, request_handler.GetMemoryReport(), description.at("id").AsInt());
+            } else if (type == "Metrics") {
+                builder.StartDict()
+                            .Key("request_id").Value(description.at("id").AsInt());
+                PrintMetrics(builder, request_handler);
+                builder.EndDict();
             }
         }
         builder.EndArray();
+        metrics::ScopedTimer timer(print_time);
+        trace::Span span("json_print", "output");
+        json::Print(json::Document{builder.Build()}, out);
+    }
+
+    void JsonReader::PrintMetricsJson(const RequestHandler& request_handler, std::ostream& out) const {
+        json::Builder builder;
+        builder.StartDict();
+        PrintMetrics(builder, request_handler);
+        builder.EndDict();
         json::Print(json::Document{builder.Build()}, out);
     }
 
+    memory::Usage JsonReader::GetDocumentMemoryUsage() const {
+        memory::Usage usage{"json.document", 0, sizeof(doc_)};
+        AddNodeUsage(doc_.GetRoot(), usage);
+        return usage;
+    }
+
+    void JsonReader::PrintMemoryReport(json::Builder& builder, memory::Report report, int id) const {
+        report.push_back(GetDocumentMemoryUsage());
+        builder.StartDict()
+                    .Key("request_id").Value(id)
+                    .Key("structures").StartArray();
+        for (const auto& usage : report) {
+            builder.StartDict()
+                        .Key("name").Value(usage.name)
+                        .Key("count").Value(CountNode(usage.count))
+                        .Key("bytes").Value(CountNode(usage.bytes))
+                    .EndDict();
+        }
+        builder.EndArray()
+                    .Key("total_bytes").Value(CountNode(memory::GetTotalBytes(report)))
+                .EndDict();
+    }
+
+    void JsonReader::PrintMetrics(json::Builder& builder, const RequestHandler& request_handler) const {
+        const metrics::Report report = metrics::Collect();
+        builder.Key("phases");
+        PrintHistograms(builder, report.phases);
+        builder.Key("requests");
+        PrintHistograms(builder, report.requests);
+        builder.Key("counters").StartDict();
+        for (const auto& [name, value] : report.counters) {
+            builder.Key(name).Value(CountNode(value));
+        }
+        builder.EndDict();
+        if (const auto stats = request_handler.GetTreeCacheStats()) {
+            builder.Key("tree_cache").StartDict()
+                        .Key("hits").Value(CountNode(stats->hits))
+                        .Key("misses").Value(CountNode(stats->misses))
+                        .Key("evictions").Value(CountNode(stats->evictions))
+                        .Key("oversized").Value(CountNode(stats->oversized))
+                        .Key("trees").Value(CountNode(stats->trees))
+                        .Key("bytes").Value(CountNode(stats->bytes))
+                        .Key("capacity_bytes").Value(CountNode(stats->capacity_bytes))
+                    .EndDict();
+        }
+        if (const auto stats = request_handler.GetContractionStats()) {
+            builder.Key("contraction_hierarchy").StartDict()
+                        .Key("preprocessing_ms").Value(stats->preprocessing_ms)
+                        .Key("original_arcs").Value(CountNode(stats->original_arcs))
+                        .Key("shortcuts").Value(CountNode(stats->shortcuts))
+                        .Key("memory_bytes").Value(CountNode(stats->memory_bytes))
+                    .EndDict();
+        }
+    }
+
     void JsonReader::PrintBusInfo(json::Builder& builder, const std::optional<BusInfo>& bus_info, int id) const {
         builder.StartDict()
                     .Key("request_id").Value(id);
@@ -206,7 +604,7 @@ namespace {
         builder.EndDict();
     }
 
-    void JsonReader::PrintStopInfo(json::Builder& builder, const std::optional<std::unordered_set<std::string_view>>& stop_info, int id) const {
+    void JsonReader::PrintStopInfo(json::Builder& builder, const std::optional<std::pmr::unordered_set<std::string_view>>& stop_info, int id) const {
         builder.StartDict()
                     .Key("request_id").Value(id);
         if (stop_info.has_value()) {
@@ -230,18 +628,23 @@ namespace {
         builder.StartDict()
                     .Key("request_id").Value(id);
         if (route_info.has_value()) {
-            builder.Key("total_time").Value(route_info->total_time)
-                    .Key("items").StartArray();
-            for (const auto& item : route_info->items) {
+            PrintRouteItems(builder, *route_info);
+        } else {
+            builder.Key("error_message").Value(std::string("not found"));
+        }
+        builder.EndDict();
+    }
+
+    // Лучший маршрут выводится как в обычном ответе, а в alternatives - все маршруты по возрастанию времени
+    void JsonReader::PrintRouteAlternatives(json::Builder& builder, const std::vector<transport_router::RouteItems>& alternatives, int id) const {
+        builder.StartDict()
+                    .Key("request_id").Value(id);
+        if (!alternatives.empty()) {
+            PrintRouteItems(builder, alternatives.front());
+            builder.Key("alternatives").StartArray();
+            for (const auto& route_info : alternatives) {
                 builder.StartDict();
-                builder.Key("time").Value(item.time)
-                        .Key("type").Value(item.type);
-                if (item.type == "Wait") {
-                    builder.Key("stop_name").Value(item.name);
-                } else if (item.type == "Bus") {
-                    builder.Key("bus").Value(item.name)
-                            .Key("span_count").Value(item.span);
-                }
+                PrintRouteItems(builder, route_info);
                 builder.EndDict();
             }
             builder.EndArray();
@@ -251,4 +654,94 @@ namespace {
         builder.EndDict();
     }
 
+    void JsonReader::PrintParetoRoutes(json::Builder& builder, const std::vector<transport_router::RouteItems>& routes, int id) const {
+        builder.StartDict()
+                    .Key("request_id").Value(id);
+        if (!routes.empty()) {
+            builder.Key("journeys").StartArray();
+            for (const auto& route_info : routes) {
+                const auto rides = std::count_if(route_info.items.begin(), route_info.items.end(), [](const auto& item) {
+                    return item.type == "Bus";
+                });
+                builder.StartDict()
+                            .Key("transfers").Value(static_cast<int>(std::max<std::ptrdiff_t>(rides - 1, 0)));
+                PrintRouteItems(builder, route_info);
+                builder.EndDict();
+            }
+            builder.EndArray();
+        } else {
+            builder.Key("error_message").Value(std::string("not found"));
+        }
+        builder.EndDict();
+    }
+
+    void JsonReader::PrintRouteItems(json::Builder& builder, const transport_router::RouteItems& route_info) const {
+        builder.Key("total_time").Value(route_info.total_time)
+                .Key("items").StartArray();
+        for (const auto& item : route_info.items) {
+            builder.StartDict();
+            builder.Key("time").Value(item.time)
+                    .Key("type").Value(std::string(item.type));
+            if (item.type == "Wait") {
+                builder.Key("stop_name").Value(std::string(item.name));
+            } else if (item.type == "Bus") {
+                builder.Key("bus").Value(std::string(item.name))
+                        .Key("span_count").Value(item.span);
+            }
+            builder.EndDict();
+        }
+        builder.EndArray();
+    }
+
+    void JsonReader::PrintStopSearch(json::Builder& builder, const std::vector<StopMatch>& stops, int id) const {
+        builder.StartDict()
+                    .Key("request_id").Value(id)
+                    .Key("stops").StartArray();
+        for (const auto& stop : stops) {
+            builder.StartDict()
+                        .Key("name").Value(std::string(stop.name))
+                        .Key("bus_count").Value(static_cast<int>(stop.bus_count))
+                    .EndDict();
+        }
+        builder.EndArray()
+                .EndDict();
+    }
+
+    void JsonReader::PrintIsochrone(json::Builder& builder, const std::optional<std::vector<transport_router::ReachableStop>>& stops, int id) const {
+        builder.StartDict()
+                    .Key("request_id").Value(id);
+        if (stops.has_value()) {
+            builder.Key("stops").StartArray();
+            for (const auto& stop : *stops) {
+                builder.StartDict()
+                            .Key("stop_name").Value(std::string(stop.name))
+                            .Key("time").Value(stop.time)
+                        .EndDict();
+            }
+            builder.EndArray();
+        } else {
+            builder.Key("error_message").Value(std::string("not found"));
+        }
+        builder.EndDict();
+    }
+
+    void JsonReader::PrintRouteMatrix(json::Builder& builder, const transport_router::RouteMatrix& route_matrix, int id) const {
+        builder.StartDict()
+                    .Key("request_id").Value(id)
+                    .Key("total_times").StartArray();
+        for (const auto& row : route_matrix) {
+            builder.StartArray();
+            for (const auto& total_time : row) {
+                if (total_time.has_value()) {
+                    builder.Value(*total_time);
+                } else {
+                    builder.Value(nullptr);
+                }
+            }
+            builder.EndArray();
+        }
+        builder.EndArray()
+                .EndDict();
+    }
+
 }  // namespace json_reader
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "map_renderer.h"
 #include "json_builder.h"
 #include "transport_router.h"
+#include "memory_usage.h"
 
 namespace json_reader {
 
@@ -14,11 +15,19 @@ namespace json_reader {
     class JsonReader {
     public:
         JsonReader(std::istream& input);
+        // Потоковая загрузка: справочник наполняется в отдельном потоке по мере разбора
+        // base_requests, и для автобусов сразу готовятся рёбра маршрутизатора.
+        // Команды в документе не сохраняются, поэтому ApplyCommands после неё ничего не делает
+        JsonReader(std::istream& input, TransportCatalogue& catalogue, transport_router::TransportRouter& router);
 
         void ApplyCommands(TransportCatalogue& catalogue) const;
         void ApplyRenderSettingsCommands(renderer::MapRenderer& renderer) const;
         void ApplyRouteSettingsCommands(transport_router::TransportRouter& router) const;
         void PrintJson(const RequestHandler& request_handler, std::ostream& out) const;
+        // Метрики программы отдельным JSON-документом, например для сброса при выходе
+        void PrintMetricsJson(const RequestHandler& request_handler, std::ostream& out) const;
+        // Память разобранного входного документа
+        memory::Usage GetDocumentMemoryUsage() const;
 
     private:
         const json::Document doc_;
@@ -33,8 +42,16 @@ namespace json_reader {
         void BusesHandle(json::Array& only_bus_commands, TransportCatalogue& catalogue) const;
 
         void PrintBusInfo(json::Builder& builder, const std::optional<BusInfo>& bus_info, int id) const;
-        void PrintStopInfo(json::Builder& builder, const std::optional<std::unordered_set<std::string_view>>& stop_info, int id) const;
+        void PrintStopInfo(json::Builder& builder, const std::optional<std::pmr::unordered_set<std::string_view>>& stop_info, int id) const;
         void PrintRouteInfo(json::Builder& builder, const std::optional<transport_router::RouteItems>& route_info, int id) const;
+        void PrintRouteAlternatives(json::Builder& builder, const std::vector<transport_router::RouteItems>& alternatives, int id) const;
+        void PrintParetoRoutes(json::Builder& builder, const std::vector<transport_router::RouteItems>& routes, int id) const;
+        void PrintRouteItems(json::Builder& builder, const transport_router::RouteItems& route_info) const;
+        void PrintStopSearch(json::Builder& builder, const std::vector<StopMatch>& stops, int id) const;
+        void PrintIsochrone(json::Builder& builder, const std::optional<std::vector<transport_router::ReachableStop>>& stops, int id) const;
+        void PrintRouteMatrix(json::Builder& builder, const transport_router::RouteMatrix& route_matrix, int id) const;
+        void PrintMetrics(json::Builder& builder, const RequestHandler& request_handler) const;
+        void PrintMemoryReport(json::Builder& builder, memory::Report report, int id) const;
     };
 
 }  // namespace json_reader
\ No newline at end of file
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "graph.h"
+#include "shortest_path_tree.h"
+#include "a_star.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// До k кратчайших простых путей из from в to по возрастанию веса (алгоритм Йена).
+// Один обратный поиск от to даёт и первый путь, и точные расстояния до to в полном графе.
+// Они служат эвристикой A* для поисков ответвлений: удаление рёбер и вершин расстояния
+// только увеличивает, поэтому оценка остаётся допустимой. Ответвления ищутся параллельно.
+// same_edge отождествляет параллельные рёбра: пути из попарно тождественных рёбер - один путь,
+// и поиск идёт как в графе, где такие рёбра склеены
+template <typename Weight, typename SameEdge = std::equal_to<EdgeId>>
+std::vector<typename ShortestPathTree<Weight>::Route> FindKShortestRoutes(const DirectedWeightedGraph<Weight>& graph,
+                                                                          VertexId from, VertexId to, size_t k,
+                                                                          SameEdge same_edge = {}) {
+    using Route = typename ShortestPathTree<Weight>::Route;
+
+    std::vector<Route> routes;
+    if (k == 0) {
+        return routes;
+    }
+
+    // Обратный поиск Дейкстры: расстояния до to и следующее ребро на кратчайшем пути к to
+    struct ReverseLabel {
+        Weight weight{};
+        EdgeId next_edge = 0;
+        bool has_next_edge = false;
+        bool reached = false;
+    };
+    std::vector<ReverseLabel> to_target(graph.GetVertexCount());
+    {
+        using QueueItem = std::pair<Weight, VertexId>;
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+        to_target[to].reached = true;
+        queue.push({Weight{}, to});
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (to_target[vertex].weight < weight) {
+                continue;
+            }
+            for (const EdgeId edge_id : graph.GetIncomingEdges(vertex)) {
+                const auto& edge = graph.GetEdge(edge_id);
+                const Weight candidate_weight = weight + edge.weight;
+                ReverseLabel& label = to_target[edge.from];
+                if (!label.reached || candidate_weight < label.weight) {
+                    label = ReverseLabel{candidate_weight, edge_id, true, true};
+                    queue.push({candidate_weight, edge.from});
+                }
+            }
+        }
+    }
+    if (!to_target[from].reached) {
+        return routes;
+    }
+
+    Route shortest{to_target[from].weight, {}};
+    for (const ReverseLabel* label = &to_target[from]; label->has_next_edge;
+         label = &to_target[graph.GetEdge(label->next_edge).to]) {
+        shortest.edges.push_back(label->next_edge);
+    }
+    routes.push_back(std::move(shortest));
+
+    auto heuristic = [&to_target](VertexId vertex) {
+        return to_target[vertex].weight;
+    };
+    auto is_shorter = [](const Route& lhs, const Route& rhs) {
+        return lhs.weight < rhs.weight || (!(rhs.weight < lhs.weight) && lhs.edges < rhs.edges);
+    };
+
+    std::vector<Route> candidates;
+    while (routes.size() < k) {
+        const Route& last = routes.back();
+        std::vector<VertexId> vertices = {from};
+        for (const EdgeId edge_id : last.edges) {
+            vertices.push_back(graph.GetEdge(edge_id).to);
+        }
+
+        // Ответвление в i-й вершине: общий с последним путём корень из первых i рёбер,
+        // дальше - кратчайший путь без вершин корня и без рёбер, которыми уже найденные
+        // пути с тем же корнем выходят из этой вершины
+        std::vector<std::optional<Route>> spurs(last.edges.size());
+        parallel::ParallelFor(last.edges.size(), [&](size_t i) {
+            std::vector<EdgeId> blocked_edges;
+            for (const Route& route : routes) {
+                if (route.edges.size() > i
+                    && std::equal(last.edges.begin(), last.edges.begin() + i, route.edges.begin(), same_edge)) {
+                    blocked_edges.push_back(route.edges[i]);
+                }
+            }
+            std::vector<char> blocked_vertices(graph.GetVertexCount(), false);
+            for (size_t j = 0; j < i; ++j) {
+                blocked_vertices[vertices[j]] = true;
+            }
+            auto is_edge_allowed = [&](EdgeId edge_id) {
+                const VertexId next = graph.GetEdge(edge_id).to;
+                return to_target[next].reached && !blocked_vertices[next]
+                    && std::none_of(blocked_edges.begin(), blocked_edges.end(), [&](EdgeId blocked_edge) {
+                           return same_edge(blocked_edge, edge_id);
+                       });
+            };
+            auto spur = FindRouteAStar(graph, vertices[i], to, heuristic, is_edge_allowed);
+            if (!spur) {
+                return;
+            }
+            Route route{Weight{}, std::vector<EdgeId>(last.edges.begin(), last.edges.begin() + i)};
+            for (const EdgeId edge_id : route.edges) {
+                route.weight += graph.GetEdge(edge_id).weight;
+            }
+            route.weight += spur->weight;
+            route.edges.insert(route.edges.end(), spur->edges.begin(), spur->edges.end());
+            spurs[i] = std::move(route);
+        });
+
+        for (auto& spur : spurs) {
+            if (!spur) {
+                continue;
+            }
+            auto same_edges = [&spur, &same_edge](const Route& route) {
+                return route.edges.size() == spur->edges.size()
+                    && std::equal(route.edges.begin(), route.edges.end(), spur->edges.begin(), same_edge);
+            };
+            if (std::none_of(candidates.begin(), candidates.end(), same_edges)
+                && std::none_of(routes.begin(), routes.end(), same_edges)) {
+                candidates.push_back(std::move(*spur));
+            }
+        }
+        if (candidates.empty()) {
+            break;
+        }
+        auto next = std::min_element(candidates.begin(), candidates.end(), is_shorter);
+        routes.push_back(std::move(*next));
+        candidates.erase(next);
+    }
+    return routes;
+}
+
+}  // namespace graph
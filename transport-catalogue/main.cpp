@@ -2,9 +2,14 @@
 #include "request_handler.h"
 #include "map_renderer.h"
 #include "transport_router.h"
+#include "snapshot.h"
+#include "trace.h"
 
 #include <iostream>
 #include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
 
 using namespace transport_catalogue;
 using namespace transport_router;
@@ -12,17 +17,50 @@ using namespace json_reader;
 using namespace renderer;
 using namespace std;
 
-int main() {
+int main(int argc, char* argv[]) {
     // fstream inputFile("input.json");
 
-    TransportCatalogue catalogue;
-    MapRenderer map_renderer;
-    TransportRouter transport_router(catalogue);
-    RequestHandler request_handler(catalogue, map_renderer, transport_router);
+    // С флагом --trace=путь интервалы работы записываются в файл для chrome://tracing
+    constexpr string_view TRACE_FLAG = "--trace="sv;
+    string trace_path;
+    // С флагом --pipeline справочник наполняется параллельно с разбором входа
+    bool is_pipelined = false;
+    // С флагом --metrics метрики выводятся в стандартный поток ошибок перед выходом
+    bool print_metrics = false;
+    for (int i = 1; i < argc; ++i) {
+        const string_view argument = argv[i];
+        if (argument.substr(0, TRACE_FLAG.size()) == TRACE_FLAG) {
+            trace_path = argument.substr(TRACE_FLAG.size());
+            trace::Enable();
+        } else if (argument == "--pipeline"sv) {
+            is_pipelined = true;
+        } else if (argument == "--metrics"sv) {
+            print_metrics = true;
+        }
+    }
 
-    JsonReader reader(cin);
-    reader.ApplyCommands(catalogue);
-    reader.ApplyRenderSettingsCommands(map_renderer);
-    reader.ApplyRouteSettingsCommands(transport_router);
+    VersionedHandle<Snapshot> versions;
+
+    auto snapshot = make_unique<Snapshot>();
+    JsonReader reader = is_pipelined
+        ? JsonReader(cin, snapshot->GetCatalogue(), snapshot->GetRouter())
+        : JsonReader(cin);
+    reader.ApplyCommands(snapshot->GetCatalogue());
+    snapshot->GetCatalogue().Freeze();
+    reader.ApplyRenderSettingsCommands(snapshot->GetRenderer());
+    reader.ApplyRouteSettingsCommands(snapshot->GetRouter());
+    versions.Publish(move(snapshot));
+
+    auto current = versions.Acquire();
+    RequestHandler request_handler(*current);
     reader.PrintJson(request_handler, cout);
+
+    if (print_metrics) {
+        reader.PrintMetricsJson(request_handler, cerr);
+        cerr << endl;
+    }
+
+    if (!trace_path.empty() && !trace::WriteFile(trace_path)) {
+        cerr << "Failed to write trace to "s << trace_path << endl;
+    }
 }
\ No newline at end of file
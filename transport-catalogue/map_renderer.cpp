@@ -1,15 +1,105 @@
 #include "map_renderer.h"
+#include "trace.h"
+#include "parallel.h"
 
 #include <memory>
 #include <cstdlib>
 #include <iostream>
 #include <optional>
 #include <utility>
+#include <cmath>
+#include <sstream>
 
 namespace renderer {
 
 namespace {
 
+    // Меньшие части слоёв остановок не окупают отдельной задачи
+    constexpr std::size_t MIN_STOP_SLICE_SIZE = 256;
+    constexpr std::size_t SLICES_PER_THREAD = 4;
+
+    using StopIterator = std::set<domain::Stop>::const_iterator;
+
+    double Length(svg::Point from, svg::Point to) {
+        return std::hypot(to.x - from.x, to.y - from.y);
+    }
+
+    double DistanceToSegment(svg::Point point, svg::Point begin, svg::Point end) {
+        const double length = Length(begin, end);
+        if (IsZero(length)) {
+            return Length(point, begin);
+        }
+        return std::abs((end.x - begin.x) * (begin.y - point.y) - (begin.x - point.x) * (end.y - begin.y)) / length;
+    }
+
+    // Отбрасывает точки ближе tolerance к предыдущей оставленной,
+    // затем упрощает ломаную алгоритмом Дугласа-Пекера
+    std::vector<std::size_t> SimplifyPolyline(const std::vector<svg::Point>& points, double tolerance) {
+        if (points.size() < 3) {
+            std::vector<std::size_t> all(points.size());
+            for (std::size_t i = 0; i < all.size(); ++i) {
+                all[i] = i;
+            }
+            return all;
+        }
+
+        std::vector<std::size_t> radial{0};
+        for (std::size_t i = 1; i + 1 < points.size(); ++i) {
+            if (Length(points[radial.back()], points[i]) >= tolerance) {
+                radial.push_back(i);
+            }
+        }
+        radial.push_back(points.size() - 1);
+
+        std::vector<bool> kept(radial.size(), false);
+        kept.front() = true;
+        kept.back() = true;
+        std::vector<std::pair<std::size_t, std::size_t>> segments{{0, radial.size() - 1}};
+        while (!segments.empty()) {
+            const auto [first, last] = segments.back();
+            segments.pop_back();
+            double max_distance = 0.0;
+            std::size_t farthest = first;
+            for (std::size_t i = first + 1; i < last; ++i) {
+                const double distance = DistanceToSegment(points[radial[i]], points[radial[first]], points[radial[last]]);
+                if (distance > max_distance) {
+                    max_distance = distance;
+                    farthest = i;
+                }
+            }
+            if (max_distance > tolerance) {
+                kept[farthest] = true;
+                segments.push_back({first, farthest});
+                segments.push_back({farthest, last});
+            }
+        }
+
+        std::vector<std::size_t> result;
+        for (std::size_t i = 0; i < radial.size(); ++i) {
+            if (kept[i]) {
+                result.push_back(radial[i]);
+            }
+        }
+        return result;
+    }
+
+    std::string BuildStyleSheet(const RenderSettings& settings) {
+        std::ostringstream out;
+        out << ".r{fill:none;stroke-width:"sv << settings.line_width
+            << ";stroke-linecap:round;stroke-linejoin:round}"sv
+            << ".u{fill:"sv << settings.underlayer_color << ";stroke:"sv << settings.underlayer_color
+            << ";stroke-width:"sv << settings.underlayer_width << ";stroke-linecap:round;stroke-linejoin:round}"sv
+            << ".b{font-family:Verdana;font-weight:bold;font-size:"sv << settings.bus_label_font_size << "px}"sv
+            << ".n{font-family:Verdana;font-size:"sv << settings.stop_label_font_size << "px}"sv
+            << ".k{fill:black}"sv
+            << ".s{fill:white}"sv;
+        for (std::size_t i = 0; i < settings.color_palette.size(); ++i) {
+            out << ".l"sv << i << "{stroke:"sv << settings.color_palette[i] << '}'
+                << ".t"sv << i << "{fill:"sv << settings.color_palette[i] << '}';
+        }
+        return out.str();
+    }
+
     class SvgCatalogue : public svg::Drawable {
     public:
         SvgCatalogue(const RenderSettings& settings, const SphereProjector& proj) :
@@ -23,6 +113,10 @@ namespace {
             return proj_;
         }
 
+        // Объекты секции defs, на которые ссылается Draw
+        virtual void DrawDefinitions(svg::ObjectContainer& /*definitions*/) const {
+        }
+
     private:
         const RenderSettings& settings_;
         const SphereProjector& proj_;
@@ -30,36 +124,49 @@ namespace {
     
     class Route : public SvgCatalogue {
     public:
-        Route(const domain::Bus& bus, const RenderSettings& settings, const SphereProjector& proj, std::size_t color) :
-            SvgCatalogue(settings, proj), bus_(bus), color_(color) {}
+        Route(const domain::Bus& bus, const RenderSettings& settings, const SphereProjector& proj, std::size_t bus_it,
+              const RouteSimplificationCache& simplification_cache) :
+            SvgCatalogue(settings, proj), bus_(bus), color_(bus_it % settings.color_palette.size()),
+            simplification_cache_(simplification_cache) {}
 
         void Draw(svg::ObjectContainer& container) const override {
             svg::Polyline polyline;
-            for (const auto& stop : bus_.stops) {
-                polyline.AddPoint(GetProj()(stop->coordinates));
-            }
-            polyline.SetStrokeColor(GetSettings().color_palette[color_])
-                    .SetFillColor("none")
-                    .SetStrokeWidth(GetSettings().line_width)
-                    .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
-                    .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
+            if (GetSettings().simplify_tolerance > 0.0) {
+                for (const auto& point : simplification_cache_.GetPoints(bus_, GetProj(), GetSettings().simplify_tolerance)) {
+                    polyline.AddPoint(point);
+                }
+            } else {
+                for (const auto& stop : bus_.stops) {
+                    polyline.AddPoint(GetProj()(stop->coordinates));
+                }
+            }
+            if (GetSettings().compact_output) {
+                polyline.SetClass("r l"s + std::to_string(color_));
+            } else {
+                polyline.SetStrokeColor(GetSettings().color_palette[color_])
+                        .SetFillColor("none")
+                        .SetStrokeWidth(GetSettings().line_width)
+                        .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
+                        .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
+            }
             container.Add(polyline);
         }
     
     private:
         const domain::Bus& bus_;
         std::size_t color_;
+        const RouteSimplificationCache& simplification_cache_;
     };
 
     class RouteNames : public SvgCatalogue {
     public:
-        RouteNames(const domain::Bus& bus, const RenderSettings& settings, const SphereProjector& proj, std::size_t color) :
-            SvgCatalogue(settings, proj), bus_(bus), color_(color) {}
+        RouteNames(const domain::Bus& bus, const RenderSettings& settings, const SphereProjector& proj, std::size_t bus_it) :
+            SvgCatalogue(settings, proj), bus_(bus), color_(bus_it % settings.color_palette.size()) {}
 
         void Draw(svg::ObjectContainer& container) const override {
             std::vector<svg::Text> route_names;
 
-            route_names.push_back(svg::Text().SetData(bus_.name)
+            route_names.push_back(svg::Text().SetData(std::string(bus_.name))
                                 .SetPosition(GetProj()(bus_.stops[0]->coordinates))
                                 .SetOffset({GetSettings().bus_label_offset[0], GetSettings().bus_label_offset[1]})
                                 .SetFontSize(GetSettings().bus_label_font_size)
@@ -71,7 +178,7 @@ namespace {
                                 .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
                                 .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND));
 
-            route_names.push_back(svg::Text().SetData(bus_.name)
+            route_names.push_back(svg::Text().SetData(std::string(bus_.name))
                                 .SetPosition(GetProj()(bus_.stops[0]->coordinates))
                                 .SetOffset({GetSettings().bus_label_offset[0], GetSettings().bus_label_offset[1]})
                                 .SetFontSize(GetSettings().bus_label_font_size)
@@ -81,7 +188,7 @@ namespace {
             if (!bus_.is_roundtrip) {
                 std::size_t stop_it = bus_.stops.size() / 2;
                 if (bus_.stops[0]->name != bus_.stops[stop_it]->name) {
-                    route_names.push_back(svg::Text().SetData(bus_.name)
+                    route_names.push_back(svg::Text().SetData(std::string(bus_.name))
                                         .SetPosition(GetProj()(bus_.stops[stop_it]->coordinates))
                                         .SetOffset({GetSettings().bus_label_offset[0], GetSettings().bus_label_offset[1]})
                                         .SetFontSize(GetSettings().bus_label_font_size)
@@ -93,7 +200,7 @@ namespace {
                                         .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
                                         .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND));
 
-                    route_names.push_back(svg::Text().SetData(bus_.name)
+                    route_names.push_back(svg::Text().SetData(std::string(bus_.name))
                                         .SetPosition(GetProj()(bus_.stops[stop_it]->coordinates))
                                         .SetOffset({GetSettings().bus_label_offset[0], GetSettings().bus_label_offset[1]})
                                         .SetFontSize(GetSettings().bus_label_font_size)
@@ -112,18 +219,66 @@ namespace {
         std::size_t color_;
     };
 
+    // Подписи маршрутов в компактном режиме: текст каждой подписи выводится
+    // один раз в секции defs, подложка и сама подпись ссылаются на него
+    class CompactRouteNames : public SvgCatalogue {
+    public:
+        CompactRouteNames(const domain::Bus& bus, const RenderSettings& settings, const SphereProjector& proj,
+                          std::size_t bus_it) :
+            SvgCatalogue(settings, proj), bus_(bus), id_("b"s + std::to_string(bus_it)),
+            fill_class_("t"s + std::to_string(bus_it % settings.color_palette.size())) {}
+
+        void DrawDefinitions(svg::ObjectContainer& definitions) const override {
+            definitions.Add(svg::Text().SetId(id_).SetClass("b").SetData(std::string(bus_.name)));
+        }
+
+        void Draw(svg::ObjectContainer& container) const override {
+            AddLabel(container, id_, GetLabelPosition(bus_.stops[0]->coordinates), fill_class_);
+            if (!bus_.is_roundtrip) {
+                std::size_t stop_it = bus_.stops.size() / 2;
+                if (bus_.stops[0]->name != bus_.stops[stop_it]->name) {
+                    AddLabel(container, id_, GetLabelPosition(bus_.stops[stop_it]->coordinates), fill_class_);
+                }
+            }
+        }
+
+    private:
+        const domain::Bus& bus_;
+        std::string id_;
+        std::string fill_class_;
+
+        // Смещение подписи переносится в координаты use, чтобы текст в defs был общим
+        svg::Point GetLabelPosition(geo::Coordinates coordinates) const {
+            const svg::Point point = GetProj()(coordinates);
+            return {point.x + GetSettings().bus_label_offset[0], point.y + GetSettings().bus_label_offset[1]};
+        }
+
+        static void AddLabel(svg::ObjectContainer& container, const std::string& id, svg::Point position,
+                             const std::string& fill_class) {
+            container.Add(svg::Use().SetHref(id).SetPosition(position).SetClass("u"));
+            container.Add(svg::Use().SetHref(id).SetPosition(position).SetClass(fill_class));
+        }
+    };
+
     class StopSymbols : public SvgCatalogue {
     public:
-        StopSymbols(const std::set<domain::Stop>& stops, const RenderSettings& settings, const SphereProjector& proj) :
-            SvgCatalogue(settings, proj), stops_(stops) {}
+        StopSymbols(StopIterator begin, StopIterator end, const RenderSettings& settings, const SphereProjector& proj) :
+            SvgCatalogue(settings, proj), begin_(begin), end_(end) {}
 
         void Draw(svg::ObjectContainer& container) const override {
             std::vector<svg::Circle> stop_symbols;
 
-            for (const auto& stop : stops_) {
-                stop_symbols.push_back(svg::Circle().SetCenter(GetProj()(stop.coordinates))
-                                                    .SetRadius(GetSettings().stop_radius)
-                                                    .SetFillColor("white"));
+            for (auto it = begin_; it != end_; ++it) {
+                const auto& stop = *it;
+                svg::Circle symbol;
+                symbol.SetCenter(GetProj()(stop.coordinates))
+                      .SetRadius(GetSettings().stop_radius);
+                if (GetSettings().compact_output) {
+                    symbol.SetClass("s");
+                } else {
+                    symbol.SetFillColor("white");
+                }
+                stop_symbols.push_back(std::move(symbol));
             }
 
             for (const auto& symbol : stop_symbols) {
@@ -132,19 +287,21 @@ namespace {
         }
     
     private:
-        const std::set<domain::Stop>& stops_;
+        StopIterator begin_;
+        StopIterator end_;
     };
 
     class StopNames : public SvgCatalogue {
     public:
-        StopNames(const std::set<domain::Stop>& stops, const RenderSettings& settings, const SphereProjector& proj) :
-            SvgCatalogue(settings, proj), stops_(stops) {}
+        StopNames(StopIterator begin, StopIterator end, const RenderSettings& settings, const SphereProjector& proj) :
+            SvgCatalogue(settings, proj), begin_(begin), end_(end) {}
 
         void Draw(svg::ObjectContainer& container) const override {
             std::vector<svg::Text> stop_names;
 
-            for (const auto& stop : stops_) {
-                stop_names.push_back(svg::Text().SetData(stop.name)
+            for (auto it = begin_; it != end_; ++it) {
+                const auto& stop = *it;
+                stop_names.push_back(svg::Text().SetData(std::string(stop.name))
                                     .SetPosition(GetProj()(stop.coordinates))
                                     .SetOffset({GetSettings().stop_label_offset[0], GetSettings().stop_label_offset[1]})
                                     .SetFontSize(GetSettings().stop_label_font_size)
@@ -155,7 +312,7 @@ namespace {
                                     .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
                                     .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND));
 
-                stop_names.push_back(svg::Text().SetData(stop.name)
+                stop_names.push_back(svg::Text().SetData(std::string(stop.name))
                                     .SetPosition(GetProj()(stop.coordinates))
                                     .SetOffset({GetSettings().stop_label_offset[0], GetSettings().stop_label_offset[1]})
                                     .SetFontSize(GetSettings().stop_label_font_size)
@@ -169,7 +326,45 @@ namespace {
         }
 
     private:
-        const std::set<domain::Stop>& stops_;
+        StopIterator begin_;
+        StopIterator end_;
+    };
+
+    class CompactStopNames : public SvgCatalogue {
+    public:
+        CompactStopNames(StopIterator begin, StopIterator end, std::size_t first_stop_it,
+                         const RenderSettings& settings, const SphereProjector& proj) :
+            SvgCatalogue(settings, proj), begin_(begin), end_(end), first_stop_it_(first_stop_it) {}
+
+        void DrawDefinitions(svg::ObjectContainer& definitions) const override {
+            std::size_t stop_it = first_stop_it_;
+            for (auto it = begin_; it != end_; ++it) {
+                definitions.Add(svg::Text().SetId(GetId(stop_it++)).SetClass("n").SetData(std::string(it->name)));
+            }
+        }
+
+        void Draw(svg::ObjectContainer& container) const override {
+            std::size_t stop_it = first_stop_it_;
+            for (auto it = begin_; it != end_; ++it) {
+                const auto& stop = *it;
+                const std::string id = GetId(stop_it++);
+
+                const svg::Point point = GetProj()(stop.coordinates);
+                const svg::Point position{point.x + GetSettings().stop_label_offset[0],
+                                          point.y + GetSettings().stop_label_offset[1]};
+                container.Add(svg::Use().SetHref(id).SetPosition(position).SetClass("u"));
+                container.Add(svg::Use().SetHref(id).SetPosition(position).SetClass("k"));
+            }
+        }
+
+    private:
+        StopIterator begin_;
+        StopIterator end_;
+        std::size_t first_stop_it_;
+
+        static std::string GetId(std::size_t stop_it) {
+            return "s"s + std::to_string(stop_it);
+        }
     };
 
     template <typename DrawableIterator>
@@ -185,13 +380,46 @@ namespace {
         DrawPicture(begin(container), end(container), target);
     }
 
+    // Каждая часть слоя рисуется в свой фрагмент, фрагменты добавляются в документ
+    // в порядке частей, поэтому вывод совпадает с последовательной отрисовкой
+    template <typename Layers>
+    void DrawPictureParallel(const Layers& layers, svg::Document& doc, std::size_t thread_count) {
+        std::vector<svg::Fragment> definitions(layers.size());
+        std::vector<svg::Fragment> objects(layers.size());
+        parallel::ParallelFor(layers.size(), [&](std::size_t i) {
+            layers[i]->DrawDefinitions(definitions[i]);
+            layers[i]->Draw(objects[i]);
+        }, thread_count);
+
+        for (auto& fragment : definitions) {
+            if (!fragment.Empty()) {
+                doc.GetDefinitions().Add(std::move(fragment));
+            }
+        }
+        for (auto& fragment : objects) {
+            if (!fragment.Empty()) {
+                doc.Add(std::move(fragment));
+            }
+        }
+    }
+
 }  // namespace
 
-    svg::Document MapRenderer::Render(const std::deque<domain::Bus>& buses) const {
+    svg::Document MapRenderer::Render(const std::pmr::deque<domain::Bus>& buses) const {
+        trace::Span render_span("map.render", "request");
         std::vector<geo::Coordinates> all_cords;
-        for(const auto& bus : buses) {
-            for (const auto& stop : bus.stops) {
-                all_cords.push_back(stop->coordinates);
+        std::set<domain::Stop> stops;
+        {
+            trace::Span span("map.projection", "request");
+            for(const auto& bus : buses) {
+                for (const auto& stop : bus.stops) {
+                    all_cords.push_back(stop->coordinates);
+                }
+            }
+            for (const auto& bus : buses) {
+                for (const auto& stop : bus.stops) {
+                    stops.insert(*stop);
+                }
             }
         }
         const SphereProjector proj {
@@ -199,26 +427,96 @@ namespace {
             settings_.width, settings_.height, settings_.padding
         };
 
-        std::set<domain::Stop> stops;
-        for (const auto& bus : buses) {
-            for (const auto& stop : bus.stops) {
-                stops.insert(*stop);
+        const std::size_t thread_count = GetThreadCount();
+        const std::size_t stop_slice_size = thread_count > 1
+            ? std::max(MIN_STOP_SLICE_SIZE, stops.size() / (thread_count * SLICES_PER_THREAD) + 1)
+            : std::max<std::size_t>(stops.size(), 1);
+
+        svg::Document doc;
+        Layers routes;
+        {
+            trace::Span span("map.routes", "request");
+            AddRouteSvg<Route>(routes, buses, proj, simplification_cache_);
+        }
+        {
+            trace::Span span("map.labels", "request");
+            if (settings_.compact_output) {
+                doc.SetStyleSheet(BuildStyleSheet(settings_));
+                AddRouteSvg<CompactRouteNames>(routes, buses, proj);
+                AddStopSvg<StopSymbols>(routes, stops, stop_slice_size, proj);
+                AddStopSvg<CompactStopNames>(routes, stops, stop_slice_size, proj);
+            } else {
+                AddRouteSvg<RouteNames>(routes, buses, proj);
+                AddStopSvg<StopSymbols>(routes, stops, stop_slice_size, proj);
+                AddStopSvg<StopNames>(routes, stops, stop_slice_size, proj);
             }
         }
 
-        std::vector<std::unique_ptr<svg::Drawable>> routes;
-        AddRouteSvg<Route>(routes, buses, proj);
-        AddRouteSvg<RouteNames>(routes, buses, proj);
-        AddStopSvg<StopSymbols>(routes, stops, proj);
-        AddStopSvg<StopNames>(routes, stops, proj);
-
-        svg::Document doc;
-        DrawPicture(routes, doc);
+        trace::Span span("map.draw", "request");
+        if (thread_count > 1) {
+            DrawPictureParallel(routes, doc, thread_count);
+        } else {
+            for (const auto& layer : routes) {
+                layer->DrawDefinitions(doc.GetDefinitions());
+            }
+            DrawPicture(routes, doc);
+        }
         return doc;
     }
 
+    std::size_t MapRenderer::GetThreadCount() const {
+        return settings_.render_threads == 0 ? parallel::GetThreadCount() : settings_.render_threads;
+    }
+
     void MapRenderer::SetSettings(RenderSettings settings) {
         settings_ = std::move(settings);
+        simplification_cache_.Clear();
+    }
+
+    const RenderSettings& MapRenderer::GetSettings() const {
+        return settings_;
+    }
+
+    void MapRenderer::ResetCache() {
+        simplification_cache_.Clear();
+    }
+
+    std::vector<svg::Point> RouteSimplificationCache::GetPoints(const domain::Bus& bus, const SphereProjector& proj,
+                                                                double tolerance) const {
+        const auto projection = proj.GetParameters();
+        {
+            std::lock_guard guard(mutex_);
+            if (projection_ != projection || tolerance_ != tolerance) {
+                points_.clear();
+                projection_ = projection;
+                tolerance_ = tolerance;
+            } else if (auto entry = points_.find(bus.name); entry != points_.end()) {
+                return entry->second;
+            }
+        }
+
+        std::vector<svg::Point> points;
+        points.reserve(bus.stops.size());
+        for (const auto& stop : bus.stops) {
+            points.push_back(proj(stop->coordinates));
+        }
+        std::vector<svg::Point> kept_points;
+        for (std::size_t stop_it : SimplifyPolyline(points, tolerance)) {
+            kept_points.push_back(points[stop_it]);
+        }
+
+        std::lock_guard guard(mutex_);
+        // Пока точки считались, другой поток мог сменить проекцию
+        if (projection_ == projection && tolerance_ == tolerance) {
+            points_.emplace(bus.name, kept_points);
+        }
+        return kept_points;
+    }
+
+    void RouteSimplificationCache::Clear() {
+        std::lock_guard guard(mutex_);
+        points_.clear();
+        projection_.reset();
     }
 
 }  // namespace renderer
\ No newline at end of file
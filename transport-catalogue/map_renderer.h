@@ -5,10 +5,18 @@
 #include "domain.h"
 
 #include <vector>
+#include <array>
 #include <string>
 #include <deque>
 #include <algorithm>
+#include <iterator>
 #include <set>
+#include <unordered_map>
+#include <string_view>
+#include <mutex>
+#include <memory>
+#include <optional>
+#include <type_traits>
 
 namespace renderer {
 
@@ -82,6 +90,15 @@ namespace {
             };
         }
 
+        double GetZoom() const {
+            return zoom_coeff_;
+        }
+
+        // Проекции с равными параметрами переводят координаты в одни и те же точки
+        std::array<double, 4> GetParameters() const {
+            return {padding_, min_lon_, max_lat_, zoom_coeff_};
+        }
+
     private:
         double padding_;
         double min_lon_ = 0;
@@ -89,6 +106,9 @@ namespace {
         double zoom_coeff_ = 0;
     };
 
+    // Часть слоя карты, определена в map_renderer.cpp
+    class SvgCatalogue;
+
 } // namespace
 
     struct RenderSettings {
@@ -104,34 +124,80 @@ namespace {
         std::string underlayer_color;
         double underlayer_width = 3.0;
         std::vector<std::string> color_palette;
+        // Допуск упрощения линий маршрутов в пикселях, 0 - без упрощения
+        double simplify_tolerance = 0.0;
+        // Компактный вывод: общие стили выносятся в тэг style, подписи - в секцию defs
+        bool compact_output = false;
+        // Число потоков отрисовки: 1 - последовательно, 0 - все доступные.
+        // Вывод от числа потоков не зависит
+        std::size_t render_threads = 1;
+    };
+
+    // Кэш упрощённых линий маршрутов: для каждого автобуса хранит спроецированные точки,
+    // оставшиеся после упрощения. Точки действительны для одной проекции и допуска,
+    // при их смене кэш очищается
+    class RouteSimplificationCache {
+    public:
+        std::vector<svg::Point> GetPoints(const domain::Bus& bus, const SphereProjector& proj, double tolerance) const;
+        void Clear();
+
+    private:
+        mutable std::mutex mutex_;
+        mutable std::optional<std::array<double, 4>> projection_;
+        mutable double tolerance_ = 0.0;
+        // Ключи - имена из хранилища справочника
+        mutable std::unordered_map<std::string_view, std::vector<svg::Point>> points_;
     };
 
     class MapRenderer {
     public:
-        svg::Document Render(const std::deque<domain::Bus>& buses) const;
+        svg::Document Render(const std::pmr::deque<domain::Bus>& buses) const;
         void SetSettings(RenderSettings settings);
+        const RenderSettings& GetSettings() const;
+        // Вызывается после изменения маршрутов или координат остановок справочника
+        void ResetCache();
             
     private:
-        RenderSettings settings_;
+        RenderSettings settings_ = {};
+        RouteSimplificationCache simplification_cache_;
 
-        template <typename Container>
-        void AddRouteSvg(std::vector<std::unique_ptr<svg::Drawable>>& routes, const std::deque<domain::Bus>& buses,
-                    const SphereProjector& proj) const {
-            std::size_t color_it = 0;
+        using Layers = std::vector<std::unique_ptr<SvgCatalogue>>;
+
+        // Номер автобуса среди автобусов с остановками задаёт его цвет и идентификатор подписи
+        template <typename Container, typename... Args>
+        void AddRouteSvg(Layers& routes, const std::pmr::deque<domain::Bus>& buses,
+                    const SphereProjector& proj, const Args&... args) const {
+            std::size_t bus_it = 0;
             for (const auto& bus : buses) {
                 if (!bus.stops.empty()) {
-                    routes.emplace_back(std::make_unique<Container>(bus, settings_, proj, 
-                                                                    color_it % settings_.color_palette.size()));
-                    ++color_it;
+                    routes.emplace_back(std::make_unique<Container>(bus, settings_, proj, bus_it, args...));
+                    ++bus_it;
                 }
             }
         }
 
+        // Остановки рисуются частями по slice_size, чтобы части можно было рисовать параллельно.
+        // Номер первой остановки части получают только слои, которые принимают его в конструкторе
         template <typename Container>
-        void AddStopSvg(std::vector<std::unique_ptr<svg::Drawable>>& routes, const std::set<domain::Stop>& stops,
+        void AddStopSvg(Layers& routes, const std::set<domain::Stop>& stops, std::size_t slice_size,
                     const SphereProjector& proj) const {
-            routes.emplace_back(std::make_unique<Container>(stops, settings_, proj));
+            using StopIterator = std::set<domain::Stop>::const_iterator;
+            std::size_t stop_it = 0;
+            for (auto begin = stops.begin(); begin != stops.end();) {
+                const std::size_t count = std::min(slice_size, stops.size() - stop_it);
+                const auto end = std::next(begin, count);
+                if constexpr (std::is_constructible_v<Container, StopIterator, StopIterator, std::size_t,
+                                                      const RenderSettings&, const SphereProjector&>) {
+                    routes.emplace_back(std::make_unique<Container>(begin, end, stop_it, settings_, proj));
+                } else {
+                    routes.emplace_back(std::make_unique<Container>(begin, end, settings_, proj));
+                }
+                stop_it += count;
+                begin = end;
+            }
         }
+
+        std::size_t GetThreadCount() const;
     };
 
 }  // namespace renderer
\ No newline at end of file
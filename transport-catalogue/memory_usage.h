@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace memory {
+
+    // Память, занятая одной структурой: число элементов и байты вместе с заголовками контейнеров
+    struct Usage {
+        std::string name;
+        std::size_t count = 0;
+        std::size_t bytes = 0;
+    };
+
+    using Report = std::vector<Usage>;
+
+    // Динамическая память строки; короткие строки хранятся внутри объекта
+    inline std::size_t GetHeapBytes(const std::string& value) {
+        const char* data = value.data();
+        const char* object = reinterpret_cast<const char*>(&value);
+        if (data >= object && data < object + sizeof(value)) {
+            return 0;
+        }
+        return value.capacity() + 1;
+    }
+
+    template <typename T, typename Allocator>
+    std::size_t GetHeapBytes(const std::vector<T, Allocator>& values) {
+        return values.capacity() * sizeof(T);
+    }
+
+    // Оценка для дека, выделяющего блоки по 512 байт, как в libstdc++
+    template <typename T, typename Allocator>
+    std::size_t GetHeapBytes(const std::deque<T, Allocator>& values) {
+        constexpr std::size_t BLOCK_BYTES = 512;
+        constexpr std::size_t block_size = sizeof(T) < BLOCK_BYTES ? BLOCK_BYTES / sizeof(T) : 1;
+        const std::size_t blocks = values.size() / block_size + 1;
+        return blocks * (block_size * sizeof(T) + sizeof(T*));
+    }
+
+    // Оценка для хеш-таблицы на узлах: массив корзин и по узлу на элемент
+    // с указателем на следующий узел и сохранённым хешем
+    template <typename HashTable>
+    std::size_t GetHashTableBytes(const HashTable& table) {
+        using Value = typename HashTable::value_type;
+        return table.bucket_count() * sizeof(void*)
+            + table.size() * (sizeof(void*) + sizeof(Value) + sizeof(std::size_t));
+    }
+
+    // Оценка для красно-чёрного дерева: цвет и три указателя в каждом узле
+    template <typename Tree>
+    std::size_t GetTreeBytes(const Tree& tree) {
+        using Value = typename Tree::value_type;
+        return tree.size() * (sizeof(Value) + 4 * sizeof(void*));
+    }
+
+    inline void Append(Report& report, std::string_view prefix, Report other) {
+        for (Usage& usage : other) {
+            usage.name.insert(0, prefix);
+            report.push_back(std::move(usage));
+        }
+    }
+
+    inline std::size_t GetTotalBytes(const Report& report) {
+        std::size_t bytes = 0;
+        for (const Usage& usage : report) {
+            bytes += usage.bytes;
+        }
+        return bytes;
+    }
+
+}  // namespace memory
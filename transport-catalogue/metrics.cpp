@@ -0,0 +1,151 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace metrics {
+
+namespace {
+
+    std::atomic<bool> enabled = true;
+
+    template <typename Metric>
+    class Family {
+    public:
+        Metric& Get(std::string_view name) {
+            std::lock_guard guard(mutex_);
+            auto it = metrics_.find(name);
+            if (it == metrics_.end()) {
+                it = metrics_.emplace(std::string(name), std::make_unique<Metric>()).first;
+            }
+            return *it->second;
+        }
+
+        template <typename Value, typename Func>
+        std::vector<std::pair<std::string, Value>> Collect(Func get_value) const {
+            std::lock_guard guard(mutex_);
+            std::vector<std::pair<std::string, Value>> result;
+            result.reserve(metrics_.size());
+            for (const auto& [name, metric] : metrics_) {
+                result.emplace_back(name, get_value(*metric));
+            }
+            return result;
+        }
+
+    private:
+        mutable std::mutex mutex_;
+        std::map<std::string, std::unique_ptr<Metric>, std::less<>> metrics_;
+    };
+
+    struct Registry {
+        Family<Histogram> phases;
+        Family<Histogram> requests;
+        Family<Counter> counters;
+    };
+
+    Registry& GetRegistry() {
+        static Registry registry;
+        return registry;
+    }
+
+}  // namespace
+
+    void Histogram::Record(std::uint64_t nanoseconds) {
+        buckets_[GetBucket(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        total_.fetch_add(nanoseconds, std::memory_order_relaxed);
+        std::uint64_t max = max_.load(std::memory_order_relaxed);
+        while (nanoseconds > max && !max_.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) {
+        }
+    }
+
+    HistogramSummary Histogram::GetSummary() const {
+        const std::uint64_t count = count_.load(std::memory_order_relaxed);
+        const double total = static_cast<double>(total_.load(std::memory_order_relaxed));
+        return {
+            count,
+            total / 1e6,
+            count > 0 ? total / count / 1e3 : 0.0,
+            GetPercentile(50, count) / 1e3,
+            GetPercentile(90, count) / 1e3,
+            GetPercentile(99, count) / 1e3,
+            max_.load(std::memory_order_relaxed) / 1e3
+        };
+    }
+
+    std::size_t Histogram::GetBucket(std::uint64_t value) {
+        if (value < EXACT_VALUES) {
+            return static_cast<std::size_t>(value);
+        }
+        // Сдвиг, после которого значение попадает в [SUB_BUCKETS, 2 * SUB_BUCKETS)
+        std::size_t shift = 1;
+        while ((value >> shift) >= 2 * SUB_BUCKETS) {
+            ++shift;
+        }
+        return EXACT_VALUES + (shift - 1) * SUB_BUCKETS + static_cast<std::size_t>((value >> shift) - SUB_BUCKETS);
+    }
+
+    std::uint64_t Histogram::GetBucketUpperBound(std::size_t bucket) {
+        if (bucket < EXACT_VALUES) {
+            return bucket;
+        }
+        const std::size_t shift = (bucket - EXACT_VALUES) / SUB_BUCKETS + 1;
+        const std::uint64_t sub_bucket = (bucket - EXACT_VALUES) % SUB_BUCKETS + SUB_BUCKETS;
+        return ((sub_bucket + 1) << shift) - 1;
+    }
+
+    // Перцентиль по методу ближайшего ранга с точностью до корзины, но не больше максимума
+    std::uint64_t Histogram::GetPercentile(double percent, std::uint64_t count) const {
+        if (count == 0) {
+            return 0;
+        }
+        const auto rank = std::max<std::uint64_t>(static_cast<std::uint64_t>(std::ceil(percent / 100.0 * count)), 1);
+        std::uint64_t seen = 0;
+        for (std::size_t bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+            seen += buckets_[bucket].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                return std::min(GetBucketUpperBound(bucket), max_.load(std::memory_order_relaxed));
+            }
+        }
+        return max_.load(std::memory_order_relaxed);
+    }
+
+    Histogram& GetPhaseHistogram(std::string_view name) {
+        return GetRegistry().phases.Get(name);
+    }
+
+    Histogram& GetRequestHistogram(std::string_view name) {
+        return GetRegistry().requests.Get(name);
+    }
+
+    Counter& GetCounter(std::string_view name) {
+        return GetRegistry().counters.Get(name);
+    }
+
+    Report Collect() {
+        const Registry& registry = GetRegistry();
+        auto get_summary = [](const Histogram& histogram) {
+            return histogram.GetSummary();
+        };
+        return {
+            registry.phases.Collect<HistogramSummary>(get_summary),
+            registry.requests.Collect<HistogramSummary>(get_summary),
+            registry.counters.Collect<std::uint64_t>([](const Counter& counter) {
+                return counter.Get();
+            })
+        };
+    }
+
+    void SetEnabled(bool value) {
+        enabled.store(value, std::memory_order_relaxed);
+    }
+
+    bool IsEnabled() {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+}  // namespace metrics
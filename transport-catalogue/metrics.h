@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace metrics {
+
+    class Counter {
+    public:
+        void Add(std::uint64_t value = 1) {
+            value_.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        std::uint64_t Get() const {
+            return value_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<std::uint64_t> value_ = 0;
+    };
+
+    struct HistogramSummary {
+        std::uint64_t count;
+        double total_ms;
+        double mean_us;
+        double p50_us;
+        double p90_us;
+        double p99_us;
+        double max_us;
+    };
+
+    // Гистограмма длительностей в наносекундах в духе HDR: значения до 128 хранятся точно,
+    // каждая следующая степень двойки делится на 64 корзины, так что относительная
+    // погрешность перцентилей не больше 1/64. Запись без блокировок
+    class Histogram {
+    public:
+        void Record(std::uint64_t nanoseconds);
+
+        HistogramSummary GetSummary() const;
+
+    private:
+        static constexpr std::size_t EXACT_VALUES = 128;
+        static constexpr std::size_t SUB_BUCKETS = 64;
+        static constexpr std::size_t BUCKET_COUNT = EXACT_VALUES + 57 * SUB_BUCKETS;
+
+        std::array<std::atomic<std::uint64_t>, BUCKET_COUNT> buckets_{};
+        std::atomic<std::uint64_t> count_ = 0;
+        std::atomic<std::uint64_t> total_ = 0;
+        std::atomic<std::uint64_t> max_ = 0;
+
+        static std::size_t GetBucket(std::uint64_t value);
+        static std::uint64_t GetBucketUpperBound(std::size_t bucket);
+        std::uint64_t GetPercentile(double percent, std::uint64_t count) const;
+    };
+
+    struct Report {
+        std::vector<std::pair<std::string, HistogramSummary>> phases;
+        std::vector<std::pair<std::string, HistogramSummary>> requests;
+        std::vector<std::pair<std::string, std::uint64_t>> counters;
+    };
+
+    // Метрики хранятся всё время работы программы, поэтому ссылки на них можно
+    // сохранять в статических переменных и не искать по имени при каждом замере
+    Histogram& GetPhaseHistogram(std::string_view name);
+    Histogram& GetRequestHistogram(std::string_view name);
+    Counter& GetCounter(std::string_view name);
+
+    // Все метрики, упорядоченные по имени
+    Report Collect();
+
+    void SetEnabled(bool enabled);
+    bool IsEnabled();
+
+    // Записывает в гистограмму время жизни объекта. Если метрики выключены, часы не читаются
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Histogram& histogram) :
+            histogram_(IsEnabled() ? &histogram : nullptr)
+        {
+            if (histogram_ != nullptr) {
+                start_ = Clock::now();
+            }
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+        ~ScopedTimer() {
+            if (histogram_ != nullptr) {
+                const auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_);
+                histogram_->Record(static_cast<std::uint64_t>(duration.count()));
+            }
+        }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        Histogram* histogram_;
+        Clock::time_point start_;
+    };
+
+}  // namespace metrics
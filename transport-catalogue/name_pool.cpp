@@ -0,0 +1,60 @@
+#include "name_pool.h"
+#include "memory_usage.h"
+
+#include <algorithm>
+
+namespace transport_catalogue {
+
+    NamePool::NamePool(std::pmr::memory_resource* resource) :
+        resource_(resource), chunks_(resource), names_(resource)
+    {}
+
+    NamePool::~NamePool() {
+        for (const auto& [data, size] : chunks_) {
+            resource_->deallocate(data, size, alignof(char));
+        }
+    }
+
+    std::string_view NamePool::Intern(std::string_view name) {
+        auto it = names_.find(name);
+        if (it != names_.end()) {
+            return *it;
+        }
+        char* data = Allocate(name.size());
+        std::copy(name.begin(), name.end(), data);
+        return *names_.insert(std::string_view(data, name.size())).first;
+    }
+
+    std::size_t NamePool::GetSize() const {
+        return names_.size();
+    }
+
+    std::size_t NamePool::GetMemoryUsage() const {
+        std::size_t bytes = memory::GetHeapBytes(chunks_) + memory::GetHashTableBytes(names_);
+        for (const auto& chunk : chunks_) {
+            bytes += chunk.second;
+        }
+        return bytes;
+    }
+
+    char* NamePool::Allocate(std::size_t size) {
+        if (size == 0) {
+            return nullptr;
+        }
+        // Длинное имя получает отдельный блок, чтобы не оставлять в общем много пустого места
+        const bool is_long = size > CHUNK_SIZE / 4;
+        if (is_long || chunk_free_ < size) {
+            const std::size_t chunk_size = is_long ? size : CHUNK_SIZE;
+            chunks_.push_back({static_cast<char*>(resource_->allocate(chunk_size, alignof(char))), chunk_size});
+            if (is_long) {
+                return chunks_.back().first;
+            }
+            chunk_ = chunks_.back().first;
+            chunk_free_ = CHUNK_SIZE;
+        }
+        char* data = chunk_ + (CHUNK_SIZE - chunk_free_);
+        chunk_free_ -= size;
+        return data;
+    }
+
+}  // namespace transport_catalogue
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace transport_catalogue {
+
+    // Хранилище имён остановок и автобусов. Каждое имя хранится один раз, только добавляется
+    // и не перемещается, поэтому string_view на него действительны, пока живо хранилище
+    class NamePool {
+    public:
+        explicit NamePool(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+        NamePool(const NamePool&) = delete;
+        NamePool& operator=(const NamePool&) = delete;
+
+        ~NamePool();
+
+        // Возвращает сохранённую копию имени, добавляя её при первом обращении
+        std::string_view Intern(std::string_view name);
+
+        std::size_t GetSize() const;
+        std::size_t GetMemoryUsage() const;
+
+    private:
+        static constexpr std::size_t CHUNK_SIZE = 4096;
+
+        std::pmr::memory_resource* resource_;
+        // Имена записываются подряд в блоки; длинные имена получают отдельный блок
+        std::pmr::vector<std::pair<char*, std::size_t>> chunks_;
+        char* chunk_ = nullptr;
+        std::size_t chunk_free_ = 0;
+        std::pmr::unordered_set<std::string_view> names_;
+
+        char* Allocate(std::size_t size);
+    };
+
+}  // namespace transport_catalogue
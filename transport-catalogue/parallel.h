@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace parallel {
+
+    inline std::size_t GetThreadCount() {
+        return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    // Вызывает func(i) для всех i из [0, count) в нескольких потоках.
+    // Индексы раздаются по одному, поэтому неравные по времени задачи распределяются равномерно.
+    // Первое выброшенное исключение пробрасывается в вызывающий поток
+    template <typename Func>
+    void ParallelFor(std::size_t count, Func func, std::size_t thread_count = GetThreadCount()) {
+        thread_count = std::min(thread_count, count);
+        if (thread_count <= 1) {
+            for (std::size_t i = 0; i < count; ++i) {
+                func(i);
+            }
+            return;
+        }
+
+        std::atomic<std::size_t> next_index = 0;
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        auto worker = [&]() {
+            for (std::size_t i = next_index++; i < count; i = next_index++) {
+                try {
+                    func(i);
+                } catch (...) {
+                    std::lock_guard guard(error_mutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                    next_index = count;
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count - 1);
+        for (std::size_t i = 1; i < thread_count; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    // Очередь ограниченной ёмкости между производителем и потребителем.
+    // Производитель ждёт, пока в очереди нет места, потребитель — пока нет элементов
+    template <typename T>
+    class BoundedQueue {
+    public:
+        explicit BoundedQueue(std::size_t capacity) :
+            capacity_(std::max<std::size_t>(capacity, 1))
+        {}
+
+        // Возвращает false, если очередь уже закрыта и элемент не добавлен
+        bool Push(T value) {
+            std::unique_lock lock(mutex_);
+            not_full_.wait(lock, [this] {
+                return is_closed_ || items_.size() < capacity_;
+            });
+            if (is_closed_) {
+                return false;
+            }
+            items_.push_back(std::move(value));
+            not_empty_.notify_one();
+            return true;
+        }
+
+        // Пустое значение означает, что очередь закрыта и все элементы разобраны
+        std::optional<T> Pop() {
+            std::unique_lock lock(mutex_);
+            not_empty_.wait(lock, [this] {
+                return is_closed_ || !items_.empty();
+            });
+            if (items_.empty()) {
+                return std::nullopt;
+            }
+            std::optional<T> value = std::move(items_.front());
+            items_.pop_front();
+            not_full_.notify_one();
+            return value;
+        }
+
+        // Новые элементы больше не принимаются, оставшиеся можно разобрать
+        void Close() {
+            std::lock_guard guard(mutex_);
+            is_closed_ = true;
+            not_full_.notify_all();
+            not_empty_.notify_all();
+        }
+
+    private:
+        const std::size_t capacity_;
+        std::mutex mutex_;
+        std::condition_variable not_full_;
+        std::condition_variable not_empty_;
+        std::deque<T> items_;
+        bool is_closed_ = false;
+    };
+
+}  // namespace parallel
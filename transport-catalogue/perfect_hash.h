@@ -0,0 +1,241 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace transport_catalogue {
+
+namespace detail {
+
+    inline std::uint64_t MixHash(std::uint64_t value) {
+        value ^= value >> 30;
+        value *= 0xbf58476d1ce4e5b9ULL;
+        value ^= value >> 27;
+        value *= 0x94d049bb133111ebULL;
+        return value ^ (value >> 31);
+    }
+
+    inline std::uint64_t HashName(std::string_view name, std::uint64_t seed) {
+        std::uint64_t hash = MixHash(seed ^ name.size());
+        std::size_t i = 0;
+        for (; i + sizeof(std::uint64_t) <= name.size(); i += sizeof(std::uint64_t)) {
+            std::uint64_t word;
+            std::memcpy(&word, name.data() + i, sizeof(word));
+            hash = MixHash(hash ^ word);
+        }
+        if (i < name.size()) {
+            std::uint64_t tail = 0;
+            std::memcpy(&tail, name.data() + i, name.size() - i);
+            hash = MixHash(hash ^ tail);
+        }
+        return hash;
+    }
+
+}  // namespace detail
+
+    // Параметры совершенной хеш-функции. По ним ключи раскладываются по ячейкам
+    // без подбора, поэтому их достаточно сохранить вместе с базой
+    struct PerfectHashParameters {
+        std::uint64_t seed = 0;
+        std::vector<std::int32_t> displacements;
+    };
+
+    // Неизменяемое отображение имён на минимальной совершенной хеш-функции в духе CHD.
+    // Ключи разбиты на корзины, и для каждой корзины подобрано смещение, при котором все её
+    // ключи попадают в свободные ячейки; ключи из одиночных корзин кладутся в оставшиеся
+    // ячейки напрямую. Номер ячейки служит плотным идентификатором ключа от 0 до size - 1.
+    // Поиск читает смещение корзины, затем ячейку и один раз сравнивает имя
+    template <typename Value>
+    class PerfectHashMap {
+    public:
+        using Entry = std::pair<std::string_view, Value>;
+
+        explicit PerfectHashMap(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) :
+            displacements_(resource), entries_(resource)
+        {}
+
+        // Строит функцию по различным ключам
+        void Build(std::vector<Entry> entries);
+
+        // Раскладывает ключи по сохранённым параметрам.
+        // Бросает std::invalid_argument, если параметры построены не по этим ключам
+        void Build(std::vector<Entry> entries, const PerfectHashParameters& parameters);
+
+        void Clear() {
+            seed_ = 0;
+            displacements_.clear();
+            entries_.clear();
+        }
+
+        std::optional<std::size_t> FindId(std::string_view key) const {
+            if (entries_.empty()) {
+                return std::nullopt;
+            }
+            const std::size_t slot = GetSlot(detail::HashName(key, seed_));
+            if (entries_[slot].first != key) {
+                return std::nullopt;
+            }
+            return slot;
+        }
+
+        const Value* Find(std::string_view key) const {
+            const auto id = FindId(key);
+            return id ? &entries_[*id].second : nullptr;
+        }
+
+        // Записи в порядке идентификаторов
+        const std::pmr::vector<Entry>& GetEntries() const {
+            return entries_;
+        }
+
+        PerfectHashParameters GetParameters() const {
+            return {seed_, std::vector<std::int32_t>(displacements_.begin(), displacements_.end())};
+        }
+
+        std::size_t GetMemoryUsage() const {
+            return displacements_.capacity() * sizeof(std::int32_t) + entries_.capacity() * sizeof(Entry);
+        }
+
+    private:
+        // В среднем KEYS_PER_BUCKET ключей на корзину: таблица смещений занимает около байта на ключ
+        static constexpr std::size_t KEYS_PER_BUCKET = 4;
+        static constexpr std::int32_t MAX_DISPLACEMENT = 1 << 20;
+        // Новые зёрна нужны только при совпадении 64-битных хешей, поэтому хватает нескольких
+        static constexpr std::uint64_t MAX_SEEDS = 64;
+
+        std::uint64_t seed_ = 0;
+        // Неотрицательное смещение перемешивается с хешем ключа, отрицательное d задаёт ячейку -d - 1
+        std::pmr::vector<std::int32_t> displacements_;
+        std::pmr::vector<Entry> entries_;
+
+        static std::size_t GetSlot(std::uint64_t hash, std::int32_t displacement, std::size_t size) {
+            if (displacement < 0) {
+                return static_cast<std::size_t>(-(displacement + 1));
+            }
+            return detail::MixHash(hash + static_cast<std::uint64_t>(displacement) * 0x9e3779b97f4a7c15ULL) % size;
+        }
+
+        std::size_t GetSlot(std::uint64_t hash) const {
+            return GetSlot(hash, displacements_[hash % displacements_.size()], entries_.size());
+        }
+
+        bool FindDisplacements(const std::vector<Entry>& entries, std::uint64_t seed);
+        bool Place(std::vector<Entry>& entries);
+    };
+
+    template <typename Value>
+    void PerfectHashMap<Value>::Build(std::vector<Entry> entries) {
+        for (std::uint64_t seed = 0; seed < MAX_SEEDS; ++seed) {
+            if (FindDisplacements(entries, seed) && Place(entries)) {
+                return;
+            }
+        }
+        Clear();
+        throw std::invalid_argument("Perfect hash keys must be distinct");
+    }
+
+    template <typename Value>
+    void PerfectHashMap<Value>::Build(std::vector<Entry> entries, const PerfectHashParameters& parameters) {
+        const std::size_t size = entries.size();
+        const bool is_valid = std::all_of(parameters.displacements.begin(), parameters.displacements.end(),
+            [size](std::int32_t displacement) {
+                return displacement >= 0 || static_cast<std::size_t>(-(displacement + 1)) < size;
+            });
+        seed_ = parameters.seed;
+        displacements_.assign(parameters.displacements.begin(), parameters.displacements.end());
+        if (!is_valid || (size > 0 && displacements_.empty()) || !Place(entries)) {
+            Clear();
+            throw std::invalid_argument("Perfect hash parameters do not match the keys");
+        }
+    }
+
+    template <typename Value>
+    bool PerfectHashMap<Value>::FindDisplacements(const std::vector<Entry>& entries, std::uint64_t seed) {
+        const std::size_t size = entries.size();
+        const std::size_t bucket_count = std::max<std::size_t>(size / KEYS_PER_BUCKET, 1);
+        seed_ = seed;
+        displacements_.assign(bucket_count, 0);
+
+        std::vector<std::uint64_t> hashes(size);
+        std::vector<std::vector<std::size_t>> buckets(bucket_count);
+        for (std::size_t i = 0; i < size; ++i) {
+            hashes[i] = detail::HashName(entries[i].first, seed);
+            buckets[hashes[i] % bucket_count].push_back(i);
+        }
+
+        // Крупные корзины раскладываются первыми, пока свободных ячеек много
+        std::vector<std::size_t> order(bucket_count);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&buckets](std::size_t lhs, std::size_t rhs) {
+            return buckets[lhs].size() > buckets[rhs].size();
+        });
+
+        std::vector<bool> is_taken(size, false);
+        std::vector<std::size_t> slots;
+        auto bucket = order.begin();
+        for (; bucket != order.end() && buckets[*bucket].size() > 1; ++bucket) {
+            const auto& keys = buckets[*bucket];
+            std::int32_t displacement = 0;
+            for (; displacement < MAX_DISPLACEMENT; ++displacement) {
+                slots.clear();
+                for (std::size_t key : keys) {
+                    const std::size_t slot = GetSlot(hashes[key], displacement, size);
+                    if (is_taken[slot] || std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+                        break;
+                    }
+                    slots.push_back(slot);
+                }
+                if (slots.size() == keys.size()) {
+                    break;
+                }
+            }
+            if (displacement == MAX_DISPLACEMENT) {
+                return false;
+            }
+            displacements_[*bucket] = displacement;
+            for (std::size_t slot : slots) {
+                is_taken[slot] = true;
+            }
+        }
+
+        std::size_t free_slot = 0;
+        for (; bucket != order.end() && buckets[*bucket].size() == 1; ++bucket) {
+            while (is_taken[free_slot]) {
+                ++free_slot;
+            }
+            is_taken[free_slot] = true;
+            displacements_[*bucket] = -static_cast<std::int32_t>(free_slot) - 1;
+        }
+        return true;
+    }
+
+    template <typename Value>
+    bool PerfectHashMap<Value>::Place(std::vector<Entry>& entries) {
+        const std::size_t size = entries.size();
+        std::vector<std::size_t> slots(size);
+        std::vector<bool> is_taken(size, false);
+        for (std::size_t i = 0; i < size; ++i) {
+            const std::uint64_t hash = detail::HashName(entries[i].first, seed_);
+            slots[i] = GetSlot(hash, displacements_[hash % displacements_.size()], size);
+            if (is_taken[slots[i]]) {
+                return false;
+            }
+            is_taken[slots[i]] = true;
+        }
+        entries_.clear();
+        entries_.resize(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            entries_[slots[i]] = std::move(entries[i]);
+        }
+        return true;
+    }
+
+}  // namespace transport_catalogue
@@ -0,0 +1,238 @@
+#include "raptor.h"
+
+#include <algorithm>
+
+namespace transport_router {
+
+    Raptor::Raptor(const TransportCatalogue& catalogue, double bus_wait_time, double bus_velocity) :
+        bus_wait_time_(bus_wait_time), bus_velocity_(bus_velocity)
+    {
+        const auto& stops = catalogue.GetStops();
+        stop_names_.reserve(stops.size());
+        for (const Stop& stop : stops) {
+            stop_names_.push_back(stop.name);
+        }
+        for (std::size_t stop = 0; stop < stop_names_.size(); ++stop) {
+            stop_indexes_.insert({stop_names_[stop], stop});
+        }
+
+        // Для некольцевого маршрута последовательность уже содержит обратный путь,
+        // поэтому каждому автобусу соответствует один маршрут
+        pattern_offsets_.push_back(0);
+        for (const Bus& bus : catalogue.GetBuses()) {
+            if (bus.stops.size() < 2) {
+                continue;
+            }
+            pattern_buses_.push_back(bus_names_.size());
+            bus_names_.push_back(bus.name);
+            double distance = 0.0;
+            for (std::size_t i = 0; i < bus.stops.size(); ++i) {
+                if (i > 0) {
+                    distance += catalogue.GetDistanceBetweenStops(bus.stops[i - 1], bus.stops[i]);
+                }
+                pattern_stops_.push_back(stop_indexes_.at(bus.stops[i]->name));
+                pattern_distances_.push_back(distance);
+            }
+            pattern_offsets_.push_back(pattern_stops_.size());
+        }
+
+        stop_offsets_.assign(stop_names_.size() + 1, 0);
+        for (const std::size_t stop : pattern_stops_) {
+            ++stop_offsets_[stop + 1];
+        }
+        for (std::size_t stop = 0; stop < stop_names_.size(); ++stop) {
+            stop_offsets_[stop + 1] += stop_offsets_[stop];
+        }
+        stop_patterns_.resize(pattern_stops_.size());
+        stop_positions_.resize(pattern_stops_.size());
+        std::vector<std::size_t> next(stop_offsets_.begin(), stop_offsets_.end() - 1);
+        for (std::size_t pattern = 0; pattern + 1 < pattern_offsets_.size(); ++pattern) {
+            for (std::size_t position = pattern_offsets_[pattern]; position < pattern_offsets_[pattern + 1]; ++position) {
+                const std::size_t index = next[pattern_stops_[position]]++;
+                stop_patterns_[index] = pattern;
+                stop_positions_[index] = position;
+            }
+        }
+    }
+
+    std::optional<std::size_t> Raptor::FindStop(std::string_view stop_name) const {
+        auto stop = stop_indexes_.find(stop_name);
+        if (stop == stop_indexes_.end()) {
+            return std::nullopt;
+        }
+        return stop->second;
+    }
+
+    std::string_view Raptor::GetStopName(std::size_t stop) const {
+        return stop_names_.at(stop);
+    }
+
+    std::string_view Raptor::GetBusName(std::size_t bus) const {
+        return bus_names_.at(bus);
+    }
+
+    std::size_t Raptor::GetStopCount() const {
+        return stop_names_.size();
+    }
+
+    double Raptor::DistanceIntoTime(double distance) const {
+        return (distance * 60) / (bus_velocity_ * 1000);
+    }
+
+    double Raptor::GetRideTime(std::size_t board, std::size_t alight) const {
+        return DistanceIntoTime(pattern_distances_[alight] - pattern_distances_[board]);
+    }
+
+    Raptor::Labels Raptor::Run(std::size_t from, std::optional<std::size_t> to, double max_time, std::size_t max_rounds) const {
+        const std::size_t stop_count = stop_names_.size();
+        const std::size_t pattern_count = pattern_offsets_.size() - 1;
+
+        Labels labels;
+        labels.best.assign(stop_count, NO_TIME_LIMIT);
+        labels.best[from] = 0.0;
+        if (to) {
+            labels.parents.emplace_back(stop_count);
+        }
+
+        // Времена прибытия не более чем с k - 1 посадками
+        std::vector<double> round_times(stop_count, NO_TIME_LIMIT);
+        round_times[from] = 0.0;
+        std::vector<std::size_t> marked = {from};
+        std::vector<char> is_marked(stop_count, false);
+        std::vector<std::size_t> pattern_start(pattern_count, NONE);
+        std::vector<std::size_t> queued_patterns;
+
+        for (std::size_t round = 1; round <= max_rounds && !marked.empty(); ++round) {
+            // Маршрут просматривается с первой позиции, где остановка улучшилась в прошлом раунде
+            for (const std::size_t stop : marked) {
+                is_marked[stop] = false;
+                for (std::size_t i = stop_offsets_[stop]; i < stop_offsets_[stop + 1]; ++i) {
+                    std::size_t& start = pattern_start[stop_patterns_[i]];
+                    if (start == NONE) {
+                        queued_patterns.push_back(stop_patterns_[i]);
+                        start = stop_positions_[i];
+                    } else {
+                        start = std::min(start, stop_positions_[i]);
+                    }
+                }
+            }
+            marked.clear();
+
+            std::vector<double> next_times = round_times;
+            std::vector<Parent> parents(to ? stop_count : 0);
+            for (const std::size_t pattern : queued_patterns) {
+                std::size_t board = NONE;
+                for (std::size_t position = pattern_start[pattern]; position < pattern_offsets_[pattern + 1]; ++position) {
+                    const std::size_t stop = pattern_stops_[position];
+                    if (board != NONE) {
+                        const double arrival = round_times[pattern_stops_[board]] + bus_wait_time_ + GetRideTime(board, position);
+                        const bool is_useful = arrival <= max_time && (!to || arrival < labels.best[*to]);
+                        if (is_useful && arrival < labels.best[stop]) {
+                            labels.best[stop] = arrival;
+                            next_times[stop] = arrival;
+                            if (to) {
+                                parents[stop] = {pattern, board, position};
+                            }
+                            if (!is_marked[stop]) {
+                                is_marked[stop] = true;
+                                marked.push_back(stop);
+                            }
+                        }
+                    }
+                    // Садиться выгоднее там, где раньше прибытие с поправкой на уже пройденный путь
+                    if (round_times[stop] < NO_TIME_LIMIT
+                        && (board == NONE
+                            || round_times[stop] - DistanceIntoTime(pattern_distances_[position])
+                                < round_times[pattern_stops_[board]] - DistanceIntoTime(pattern_distances_[board]))) {
+                        board = position;
+                    }
+                }
+                pattern_start[pattern] = NONE;
+            }
+            queued_patterns.clear();
+
+            round_times = std::move(next_times);
+            if (to) {
+                labels.parents.push_back(std::move(parents));
+            }
+        }
+        return labels;
+    }
+
+    std::optional<Raptor::Journey> Raptor::FindJourney(std::size_t from, std::size_t to) const {
+        const Labels labels = Run(from, to, NO_TIME_LIMIT);
+        if (labels.best[to] == NO_TIME_LIMIT) {
+            return std::nullopt;
+        }
+        return RestoreJourney(labels, to, labels.parents.size() - 1);
+    }
+
+    std::vector<Raptor::Journey> Raptor::FindParetoJourneys(std::size_t from, std::size_t to, std::size_t max_transfers) const {
+        std::vector<Journey> journeys;
+        if (from == to) {
+            journeys.push_back({0.0, {}});
+            return journeys;
+        }
+        const Labels labels = Run(from, to, NO_TIME_LIMIT, max_transfers + 1);
+        for (std::size_t round = 1; round < labels.parents.size(); ++round) {
+            if (labels.parents[round][to].pattern != NONE) {
+                journeys.push_back(RestoreJourney(labels, to, round));
+            }
+        }
+        return journeys;
+    }
+
+    Raptor::Journey Raptor::RestoreJourney(const Labels& labels, std::size_t to, std::size_t last_round) const {
+        // Метка остановки к раунду k установлена в последнем раунде не позже k, где она улучшалась
+        auto find_round = [&labels](std::size_t stop, std::size_t max_round) {
+            std::size_t round = max_round;
+            while (round > 0 && labels.parents[round][stop].pattern == NONE) {
+                --round;
+            }
+            return round;
+        };
+
+        Journey journey{0.0, {}};
+        std::size_t stop = to;
+        std::size_t round = find_round(stop, last_round);
+        while (round > 0) {
+            const Parent& parent = labels.parents[round][stop];
+            journey.legs.push_back({
+                pattern_stops_[parent.board],
+                pattern_buses_[parent.pattern],
+                static_cast<int>(parent.alight - parent.board),
+                GetRideTime(parent.board, parent.alight)
+            });
+            stop = pattern_stops_[parent.board];
+            round = find_round(stop, round - 1);
+        }
+        std::reverse(journey.legs.begin(), journey.legs.end());
+        // Время складывается в том же порядке, что и при поиске
+        for (const Leg& leg : journey.legs) {
+            journey.total_time = journey.total_time + bus_wait_time_ + leg.ride_time;
+        }
+        return journey;
+    }
+
+    std::vector<std::optional<double>> Raptor::GetArrivalTimes(std::size_t from, double max_time) const {
+        const Labels labels = Run(from, std::nullopt, max_time);
+        std::vector<std::optional<double>> times(labels.best.size());
+        for (std::size_t stop = 0; stop < labels.best.size(); ++stop) {
+            if (labels.best[stop] < NO_TIME_LIMIT && labels.best[stop] <= max_time) {
+                times[stop] = labels.best[stop];
+            }
+        }
+        return times;
+    }
+
+    std::size_t Raptor::GetMemoryUsage() const {
+        std::size_t bytes = sizeof(*this);
+        bytes += (stop_names_.capacity() + bus_names_.capacity()) * sizeof(std::string_view);
+        bytes += stop_indexes_.size() * (sizeof(std::string_view) + 2 * sizeof(std::size_t));
+        bytes += (pattern_offsets_.capacity() + pattern_buses_.capacity() + pattern_stops_.capacity()
+                  + stop_offsets_.capacity() + stop_patterns_.capacity() + stop_positions_.capacity()) * sizeof(std::size_t);
+        bytes += pattern_distances_.capacity() * sizeof(double);
+        return bytes;
+    }
+
+}  // namespace transport_router
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "transport_catalogue.h"
+
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace transport_router {
+
+    using namespace transport_catalogue;
+
+    // Поиск маршрутов по раундам в духе RAPTOR: в раунде k каждый маршрут автобуса
+    // просматривается один раз, и находятся лучшие времена прибытия не более чем с k посадками.
+    // Работает прямо с последовательностями остановок автобусов, без графа с рёбрами
+    // между всеми парами остановок маршрута
+    class Raptor {
+    public:
+        static constexpr double NO_TIME_LIMIT = std::numeric_limits<double>::infinity();
+
+        struct Leg {
+            std::size_t stop;
+            std::size_t bus;
+            int span_count;
+            double ride_time;
+        };
+
+        struct Journey {
+            double total_time;
+            std::vector<Leg> legs;
+        };
+
+        Raptor(const TransportCatalogue& catalogue, double bus_wait_time, double bus_velocity);
+
+        std::optional<std::size_t> FindStop(std::string_view stop_name) const;
+        std::string_view GetStopName(std::size_t stop) const;
+        std::string_view GetBusName(std::size_t bus) const;
+        std::size_t GetStopCount() const;
+
+        std::optional<Journey> FindJourney(std::size_t from, std::size_t to) const;
+
+        // Парето-оптимальные по времени и числу пересадок поездки, по возрастанию числа пересадок.
+        // Поездка с k посадками - лучшая метка цели в раунде k, если она улучшилась в этом раунде
+        std::vector<Journey> FindParetoJourneys(std::size_t from, std::size_t to, std::size_t max_transfers) const;
+
+        // Лучшие времена прибытия на все остановки, не превышающие max_time
+        std::vector<std::optional<double>> GetArrivalTimes(std::size_t from, double max_time = NO_TIME_LIMIT) const;
+
+        std::size_t GetMemoryUsage() const;
+
+    private:
+        static constexpr std::size_t NONE = std::numeric_limits<std::size_t>::max();
+
+        // Откуда пришли на остановку в раунде: посадка и высадка - позиции в маршруте
+        struct Parent {
+            std::size_t pattern = NONE;
+            std::size_t board = 0;
+            std::size_t alight = 0;
+        };
+
+        struct Labels {
+            std::vector<double> best;
+            std::vector<std::vector<Parent>> parents;
+        };
+
+        double bus_wait_time_;
+        double bus_velocity_;
+
+        // Имена ссылаются на хранилище имён справочника
+        std::vector<std::string_view> stop_names_;
+        std::unordered_map<std::string_view, std::size_t> stop_indexes_;
+        std::vector<std::string_view> bus_names_;
+
+        // Маршруты автобусов подряд в одном массиве: остановки и расстояния от начала маршрута
+        std::vector<std::size_t> pattern_offsets_;
+        std::vector<std::size_t> pattern_buses_;
+        std::vector<std::size_t> pattern_stops_;
+        std::vector<double> pattern_distances_;
+
+        // Для каждой остановки - маршруты и позиции в них, где она встречается
+        std::vector<std::size_t> stop_offsets_;
+        std::vector<std::size_t> stop_patterns_;
+        std::vector<std::size_t> stop_positions_;
+
+        double DistanceIntoTime(double distance) const;
+        double GetRideTime(std::size_t board, std::size_t alight) const;
+
+        Labels Run(std::size_t from, std::optional<std::size_t> to, double max_time, std::size_t max_rounds = NONE) const;
+
+        Journey RestoreJourney(const Labels& labels, std::size_t to, std::size_t last_round) const;
+    };
+
+}  // namespace transport_router
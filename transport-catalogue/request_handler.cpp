@@ -1,4 +1,6 @@
 #include "request_handler.h"
+#include "metrics.h"
+#include "trace.h"
 
 #include <algorithm>
 
@@ -6,7 +8,38 @@ namespace transport_catalogue {
 
     using namespace domain;
 
+namespace {
+
+    constexpr char BUS_REQUEST[] = "Bus";
+    constexpr char STOP_REQUEST[] = "Stop";
+    constexpr char STOP_SEARCH_REQUEST[] = "StopSearch";
+    constexpr char MAP_REQUEST[] = "Map";
+    constexpr char ROUTE_REQUEST[] = "Route";
+    constexpr char ISOCHRONE_REQUEST[] = "Isochrone";
+    constexpr char ROUTE_ALTERNATIVES_REQUEST[] = "RouteAlternatives";
+    constexpr char PARETO_ROUTES_REQUEST[] = "ParetoRoutes";
+    constexpr char ROUTE_MATRIX_REQUEST[] = "RouteMatrix";
+
+    // Замеряет время обработки запроса типа Name для метрик и трассировки
+    template <const char* Name>
+    class RequestScope {
+    public:
+        RequestScope() : timer_(GetLatency()), span_(Name, "request") {}
+
+    private:
+        metrics::ScopedTimer timer_;
+        trace::Span span_;
+
+        static metrics::Histogram& GetLatency() {
+            static auto& latency = metrics::GetRequestHistogram(Name);
+            return latency;
+        }
+    };
+
+}  // namespace
+
     const std::optional<BusInfo> RequestHandler::GetBusStat(const std::string_view& bus_name) const {
+        RequestScope<BUS_REQUEST> scope;
         auto bus = db_.FindBus(bus_name);
         if (bus != nullptr) {
             return db_.GetBusInfo(bus->name);
@@ -14,7 +47,8 @@ namespace transport_catalogue {
         return std::nullopt;
     }
 
-    const std::optional<std::unordered_set<std::string_view>> RequestHandler::GetBusesByStop(const std::string_view& stop_name) const {
+    const std::optional<std::pmr::unordered_set<std::string_view>> RequestHandler::GetBusesByStop(const std::string_view& stop_name) const {
+        RequestScope<STOP_REQUEST> scope;
         auto stop = db_.FindStop(stop_name);
         if (stop != nullptr) {
             return db_.GetStopInfo(stop->name);
@@ -22,7 +56,13 @@ namespace transport_catalogue {
         return std::nullopt;
     }
 
+    std::vector<StopMatch> RequestHandler::SearchStops(const std::string_view prefix, std::size_t limit) const {
+        RequestScope<STOP_SEARCH_REQUEST> scope;
+        return db_.SearchStops(prefix, limit);
+    }
+
     svg::Document RequestHandler::RenderMap() const {
+        RequestScope<MAP_REQUEST> scope;
         auto buses = db_.GetBuses();
         std::sort(buses.begin(), buses.end(), [](const Bus& a, const Bus& b) 
             {
@@ -36,7 +76,57 @@ namespace transport_catalogue {
         const std::string_view from, 
         const std::string_view to
     ) const {
+        RequestScope<ROUTE_REQUEST> scope;
         return router_.GetRouteInfo(from, to);
     }
 
+    std::optional<std::vector<transport_router::ReachableStop>> RequestHandler::GetIsochrone(
+        const std::string_view from,
+        double max_time
+    ) const {
+        RequestScope<ISOCHRONE_REQUEST> scope;
+        return router_.GetIsochrone(from, max_time);
+    }
+
+    std::vector<transport_router::RouteItems> RequestHandler::GetRouteAlternatives(
+        const std::string_view from,
+        const std::string_view to,
+        std::size_t count
+    ) const {
+        RequestScope<ROUTE_ALTERNATIVES_REQUEST> scope;
+        return router_.GetRouteAlternatives(from, to, count);
+    }
+
+    std::vector<transport_router::RouteItems> RequestHandler::GetParetoRoutes(
+        const std::string_view from,
+        const std::string_view to,
+        std::size_t max_transfers
+    ) const {
+        RequestScope<PARETO_ROUTES_REQUEST> scope;
+        return router_.GetParetoRoutes(from, to, max_transfers);
+    }
+
+    transport_router::RouteMatrix RequestHandler::GetRouteMatrix(
+        const std::vector<std::string_view>& from,
+        const std::vector<std::string_view>& to
+    ) const {
+        RequestScope<ROUTE_MATRIX_REQUEST> scope;
+        return router_.GetRouteMatrix(from, to);
+    }
+
+    std::optional<graph::ShortestPathTreeCache<double>::Stats> RequestHandler::GetTreeCacheStats() const {
+        return router_.GetTreeCacheStats();
+    }
+
+    std::optional<graph::ContractionHierarchy<double>::Stats> RequestHandler::GetContractionStats() const {
+        return router_.GetContractionStats();
+    }
+
+    memory::Report RequestHandler::GetMemoryReport() const {
+        memory::Report report;
+        memory::Append(report, "catalogue.", db_.GetMemoryReport());
+        memory::Append(report, "transport_router.", router_.GetMemoryReport());
+        return report;
+    }
+
 }  // namespace transport_catalogue
\ No newline at end of file
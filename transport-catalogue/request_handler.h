@@ -5,6 +5,7 @@
 #include "transport_catalogue.h"
 #include "map_renderer.h"
 #include "transport_router.h"
+#include "snapshot.h"
 
 namespace transport_catalogue {
 
@@ -18,14 +19,50 @@ namespace transport_catalogue {
             db_(db), renderer_(renderer), router_(router)
         {}
 
+        // Обработчик запросов к закреплённой версии справочника
+        explicit RequestHandler(const Snapshot& snapshot) :
+            RequestHandler(snapshot.GetCatalogue(), snapshot.GetRenderer(), snapshot.GetRouter())
+        {}
+
         const std::optional<BusInfo> GetBusStat(const std::string_view& bus_name) const;
 
-        const std::optional<std::unordered_set<std::string_view>> GetBusesByStop(const std::string_view& stop_name) const;
+        const std::optional<std::pmr::unordered_set<std::string_view>> GetBusesByStop(const std::string_view& stop_name) const;
+
+        std::vector<StopMatch> SearchStops(const std::string_view prefix, std::size_t limit) const;
 
         svg::Document RenderMap() const;
 
         std::optional<transport_router::RouteItems> GetRouteInfo(const std::string_view from, const std::string_view to) const;
 
+        std::optional<std::vector<transport_router::ReachableStop>> GetIsochrone(
+            const std::string_view from,
+            double max_time
+        ) const;
+
+        std::vector<transport_router::RouteItems> GetRouteAlternatives(
+            const std::string_view from,
+            const std::string_view to,
+            std::size_t count
+        ) const;
+
+        std::vector<transport_router::RouteItems> GetParetoRoutes(
+            const std::string_view from,
+            const std::string_view to,
+            std::size_t max_transfers
+        ) const;
+
+        transport_router::RouteMatrix GetRouteMatrix(
+            const std::vector<std::string_view>& from,
+            const std::vector<std::string_view>& to
+        ) const;
+
+        std::optional<graph::ShortestPathTreeCache<double>::Stats> GetTreeCacheStats() const;
+
+        std::optional<graph::ContractionHierarchy<double>::Stats> GetContractionStats() const;
+
+        // Память справочника и маршрутизатора по структурам
+        memory::Report GetMemoryReport() const;
+
     private:
         const TransportCatalogue& db_;
         const renderer::MapRenderer& renderer_;
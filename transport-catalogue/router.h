@@ -1,6 +1,7 @@
 #pragma once
 
 #include "graph.h"
+#include "shortest_path_tree.h"
 
 #include <algorithm>
 #include <cassert>
@@ -9,6 +10,7 @@
 #include <optional>
 #include <stdexcept>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -22,6 +24,9 @@ private:
 public:
     explicit Router(const Graph& graph);
 
+    // Копия маршрутов other для graph - копии графа, по которому построен other
+    Router(const Router& other, const Graph& graph);
+
     struct RouteInfo {
         Weight weight;
         std::vector<EdgeId> edges;
@@ -29,6 +34,17 @@ public:
 
     std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
 
+    // Вес маршрута без восстановления его рёбер
+    std::optional<Weight> GetRouteWeight(VertexId from, VertexId to) const;
+
+    // Приводит маршруты в соответствие с изменённым графом: в него добавлены вершины
+    // и рёбра added_edges, удалены рёбра removed_edges. Пересчитываются только
+    // маршруты из вершин, которые затронуты изменениями
+    void Update(const std::vector<EdgeId>& added_edges, const std::vector<EdgeId>& removed_edges);
+
+    // Память таблицы маршрутов между всеми парами вершин
+    memory::Usage GetMemoryUsage() const;
+
 private:
     struct RouteInternalData {
         Weight weight;
@@ -75,6 +91,39 @@ private:
         }
     }
 
+    bool IsAffected(VertexId vertex_from, const std::vector<EdgeId>& added_edges,
+                    const std::unordered_set<EdgeId>& removed_edges) const {
+        const auto& routes = routes_internal_data_[vertex_from];
+        const bool uses_removed = std::any_of(routes.begin(), routes.end(), [&removed_edges](const auto& route) {
+            return route && route->prev_edge && removed_edges.count(*route->prev_edge) > 0;
+        });
+        if (uses_removed) {
+            return true;
+        }
+        // Если ни одно новое ребро не улучшает маршрут до своего конца,
+        // то не улучшается и ни один другой маршрут из этой вершины
+        return std::any_of(added_edges.begin(), added_edges.end(), [this, &routes](EdgeId edge_id) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            const auto& route_to_tail = routes[edge.from];
+            const auto& route_to_head = routes[edge.to];
+            return route_to_tail
+                && (!route_to_head || route_to_tail->weight + edge.weight < route_to_head->weight);
+        });
+    }
+
+    // Пересчитывает маршруты из вершины алгоритмом Дейкстры
+    void RebuildRoutesFrom(VertexId vertex_from) {
+        const ShortestPathTree<Weight> tree(graph_, vertex_from);
+        auto& routes = routes_internal_data_[vertex_from];
+        for (VertexId vertex = 0; vertex < routes.size(); ++vertex) {
+            if (const auto weight = tree.GetWeight(vertex)) {
+                routes[vertex] = RouteInternalData{*weight, tree.GetPrevEdge(vertex)};
+            } else {
+                routes[vertex] = std::nullopt;
+            }
+        }
+    }
+
     static constexpr Weight ZERO_WEIGHT{};
     const Graph& graph_;
     RoutesInternalData routes_internal_data_;
@@ -94,6 +143,13 @@ Router<Weight>::Router(const Graph& graph)
     }
 }
 
+template <typename Weight>
+Router<Weight>::Router(const Router& other, const Graph& graph)
+    : graph_(graph)
+    , routes_internal_data_(other.routes_internal_data_)
+{
+}
+
 template <typename Weight>
 std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
                                                                              VertexId to) const {
@@ -114,4 +170,53 @@ std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(Ver
     return RouteInfo{weight, std::move(edges)};
 }
 
+template <typename Weight>
+std::optional<Weight> Router<Weight>::GetRouteWeight(VertexId from, VertexId to) const {
+    const auto& route_internal_data = routes_internal_data_.at(from).at(to);
+    if (!route_internal_data) {
+        return std::nullopt;
+    }
+    return route_internal_data->weight;
+}
+
+template <typename Weight>
+void Router<Weight>::Update(const std::vector<EdgeId>& added_edges, const std::vector<EdgeId>& removed_edges) {
+    for (const EdgeId edge_id : added_edges) {
+        if (graph_.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+
+    const size_t old_vertex_count = routes_internal_data_.size();
+    const size_t vertex_count = graph_.GetVertexCount();
+    std::vector<bool> affected(vertex_count, false);
+    if (vertex_count > old_vertex_count) {
+        for (auto& routes : routes_internal_data_) {
+            routes.resize(vertex_count);
+        }
+        routes_internal_data_.resize(vertex_count, std::vector<std::optional<RouteInternalData>>(vertex_count));
+        std::fill(affected.begin() + old_vertex_count, affected.end(), true);
+    }
+
+    const std::unordered_set<EdgeId> removed(removed_edges.begin(), removed_edges.end());
+    for (VertexId vertex_from = 0; vertex_from < old_vertex_count; ++vertex_from) {
+        affected[vertex_from] = IsAffected(vertex_from, added_edges, removed);
+    }
+    for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
+        if (affected[vertex_from]) {
+            RebuildRoutesFrom(vertex_from);
+        }
+    }
+}
+
+template <typename Weight>
+memory::Usage Router<Weight>::GetMemoryUsage() const {
+    memory::Usage usage{"routes_internal_data", 0, memory::GetHeapBytes(routes_internal_data_)};
+    for (const auto& routes : routes_internal_data_) {
+        usage.count += routes.size();
+        usage.bytes += memory::GetHeapBytes(routes);
+    }
+    return usage;
+}
+
 }  // namespace graph
\ No newline at end of file
@@ -0,0 +1,301 @@
+#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Дерево кратчайших путей из одной вершины, построенное алгоритмом Дейкстры
+template <typename Weight>
+class ShortestPathTree {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    struct Route {
+        Weight weight;
+        std::vector<EdgeId> edges;
+    };
+
+    ShortestPathTree(const Graph& graph, VertexId source);
+
+    VertexId GetSource() const;
+    bool IsReached(VertexId vertex) const;
+    std::optional<Weight> GetWeight(VertexId vertex) const;
+    std::optional<EdgeId> GetPrevEdge(VertexId vertex) const;
+
+    // Восстанавливает путь до вершины по рёбрам-предшественникам
+    std::optional<Route> BuildRoute(VertexId to) const;
+
+    size_t GetMemoryUsage() const;
+
+    // Память дерева для графа из vertex_count вершин
+    static size_t GetMemoryUsage(size_t vertex_count);
+
+private:
+    static constexpr EdgeId NO_EDGE = static_cast<EdgeId>(-1);
+    static constexpr Weight ZERO_WEIGHT{};
+
+    struct Entry {
+        Weight weight{};
+        EdgeId prev_edge = NO_EDGE;
+    };
+
+    const Graph& graph_;
+    VertexId source_;
+    std::vector<Entry> entries_;
+};
+
+template <typename Weight>
+ShortestPathTree<Weight>::ShortestPathTree(const Graph& graph, VertexId source)
+    : graph_(graph)
+    , source_(source)
+    , entries_(graph.GetVertexCount())
+{
+    std::vector<bool> reached(entries_.size(), false);
+    reached[source] = true;
+    entries_[source] = Entry{ZERO_WEIGHT, NO_EDGE};
+
+    using QueueItem = std::pair<Weight, VertexId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    queue.push({ZERO_WEIGHT, source});
+    while (!queue.empty()) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (entries_[vertex].weight < weight) {
+            continue;
+        }
+        for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+            const auto& edge = graph.GetEdge(edge_id);
+            const Weight candidate_weight = weight + edge.weight;
+            auto& entry = entries_[edge.to];
+            if (!reached[edge.to] || candidate_weight < entry.weight) {
+                reached[edge.to] = true;
+                entry = Entry{candidate_weight, edge_id};
+                queue.push({candidate_weight, edge.to});
+            }
+        }
+    }
+}
+
+template <typename Weight>
+VertexId ShortestPathTree<Weight>::GetSource() const {
+    return source_;
+}
+
+template <typename Weight>
+bool ShortestPathTree<Weight>::IsReached(VertexId vertex) const {
+    return vertex == source_ || entries_.at(vertex).prev_edge != NO_EDGE;
+}
+
+template <typename Weight>
+std::optional<Weight> ShortestPathTree<Weight>::GetWeight(VertexId vertex) const {
+    if (!IsReached(vertex)) {
+        return std::nullopt;
+    }
+    return entries_[vertex].weight;
+}
+
+template <typename Weight>
+std::optional<EdgeId> ShortestPathTree<Weight>::GetPrevEdge(VertexId vertex) const {
+    if (entries_.at(vertex).prev_edge == NO_EDGE) {
+        return std::nullopt;
+    }
+    return entries_[vertex].prev_edge;
+}
+
+template <typename Weight>
+std::optional<typename ShortestPathTree<Weight>::Route> ShortestPathTree<Weight>::BuildRoute(VertexId to) const {
+    if (!IsReached(to)) {
+        return std::nullopt;
+    }
+    std::vector<EdgeId> edges;
+    for (EdgeId edge_id = entries_[to].prev_edge; edge_id != NO_EDGE;
+         edge_id = entries_[graph_.GetEdge(edge_id).from].prev_edge) {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+    return Route{entries_[to].weight, std::move(edges)};
+}
+
+template <typename Weight>
+size_t ShortestPathTree<Weight>::GetMemoryUsage() const {
+    return sizeof(*this) + entries_.capacity() * sizeof(Entry);
+}
+
+template <typename Weight>
+size_t ShortestPathTree<Weight>::GetMemoryUsage(size_t vertex_count) {
+    return sizeof(ShortestPathTree) + vertex_count * sizeof(Entry);
+}
+
+// Вершины, достижимые из source с весом пути не больше max_weight, в порядке неубывания веса.
+// Поиск не выходит за пределы бюджета и не выделяет память под весь граф
+template <typename Weight>
+std::vector<std::pair<VertexId, Weight>> FindReachableVertices(const DirectedWeightedGraph<Weight>& graph,
+                                                               VertexId source, Weight max_weight) {
+    std::vector<std::pair<VertexId, Weight>> reachable;
+    if (max_weight < Weight{}) {
+        return reachable;
+    }
+    std::unordered_map<VertexId, Weight> weights;
+    weights[source] = Weight{};
+
+    using QueueItem = std::pair<Weight, VertexId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    queue.push({Weight{}, source});
+    while (!queue.empty()) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (weights.at(vertex) < weight) {
+            continue;
+        }
+        reachable.push_back({vertex, weight});
+        for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+            const auto& edge = graph.GetEdge(edge_id);
+            const Weight candidate_weight = weight + edge.weight;
+            if (max_weight < candidate_weight) {
+                continue;
+            }
+            auto [it, inserted] = weights.try_emplace(edge.to, candidate_weight);
+            if (inserted || candidate_weight < it->second) {
+                it->second = candidate_weight;
+                queue.push({candidate_weight, edge.to});
+            }
+        }
+    }
+    return reachable;
+}
+
+// Потокобезопасный LRU-кэш деревьев кратчайших путей с ограничением по памяти.
+// Разбит на независимые сегменты, чтобы параллельные читатели не ждали друг друга
+template <typename Weight>
+class ShortestPathTreeCache {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using TreePtr = std::shared_ptr<const ShortestPathTree<Weight>>;
+
+    struct Stats {
+        size_t hits;
+        size_t misses;
+        size_t evictions;
+        // Деревья, которые не кэшированы, потому что больше сегмента
+        size_t oversized;
+        size_t trees;
+        size_t bytes;
+        size_t capacity_bytes;
+    };
+
+    // Сегментов не больше, чем в кэш помещается деревьев графа из vertex_count вершин,
+    // чтобы такое дерево помещалось в свой сегмент
+    ShortestPathTreeCache(size_t capacity_bytes, size_t vertex_count, size_t max_shard_count = 16);
+
+    // Возвращает дерево из кэша, а при промахе строит его и кэширует
+    TreePtr Get(const Graph& graph, VertexId source);
+
+    void Clear();
+
+    Stats GetStats() const;
+
+private:
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<std::pair<VertexId, TreePtr>> lru;
+        std::unordered_map<VertexId, typename std::list<std::pair<VertexId, TreePtr>>::iterator> index;
+        size_t bytes = 0;
+    };
+
+    size_t capacity_bytes_;
+    size_t shard_capacity_;
+    std::vector<Shard> shards_;
+    std::atomic<size_t> hits_ = 0;
+    std::atomic<size_t> misses_ = 0;
+    std::atomic<size_t> evictions_ = 0;
+    std::atomic<size_t> oversized_ = 0;
+
+    Shard& GetShard(VertexId source) {
+        return shards_[source % shards_.size()];
+    }
+};
+
+template <typename Weight>
+ShortestPathTreeCache<Weight>::ShortestPathTreeCache(size_t capacity_bytes, size_t vertex_count,
+                                                     size_t max_shard_count)
+    : capacity_bytes_(capacity_bytes)
+    , shards_(std::clamp<size_t>(capacity_bytes / ShortestPathTree<Weight>::GetMemoryUsage(vertex_count),
+                                 1, std::max<size_t>(max_shard_count, 1))) {
+    shard_capacity_ = capacity_bytes_ / shards_.size();
+}
+
+template <typename Weight>
+typename ShortestPathTreeCache<Weight>::TreePtr ShortestPathTreeCache<Weight>::Get(const Graph& graph,
+                                                                                    VertexId source) {
+    Shard& shard = GetShard(source);
+    {
+        std::lock_guard guard(shard.mutex);
+        if (auto it = shard.index.find(source); it != shard.index.end()) {
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            ++hits_;
+            return it->second->second;
+        }
+    }
+    ++misses_;
+
+    // Дерево строится без блокировки: при одновременном промахе его могут построить дважды
+    TreePtr tree = std::make_shared<const ShortestPathTree<Weight>>(graph, source);
+    const size_t tree_bytes = tree->GetMemoryUsage();
+    if (tree_bytes > shard_capacity_) {
+        ++oversized_;
+        return tree;
+    }
+
+    std::lock_guard guard(shard.mutex);
+    if (shard.index.count(source) > 0) {
+        return tree;
+    }
+    while (!shard.lru.empty() && shard.bytes + tree_bytes > shard_capacity_) {
+        shard.bytes -= shard.lru.back().second->GetMemoryUsage();
+        shard.index.erase(shard.lru.back().first);
+        shard.lru.pop_back();
+        ++evictions_;
+    }
+    shard.lru.emplace_front(source, tree);
+    shard.index[source] = shard.lru.begin();
+    shard.bytes += tree_bytes;
+    return tree;
+}
+
+template <typename Weight>
+void ShortestPathTreeCache<Weight>::Clear() {
+    for (Shard& shard : shards_) {
+        std::lock_guard guard(shard.mutex);
+        shard.lru.clear();
+        shard.index.clear();
+        shard.bytes = 0;
+    }
+}
+
+template <typename Weight>
+typename ShortestPathTreeCache<Weight>::Stats ShortestPathTreeCache<Weight>::GetStats() const {
+    Stats stats{hits_.load(), misses_.load(), evictions_.load(), oversized_.load(), 0, 0, capacity_bytes_};
+    for (const Shard& shard : shards_) {
+        std::lock_guard guard(shard.mutex);
+        stats.trees += shard.lru.size();
+        stats.bytes += shard.bytes;
+    }
+    return stats;
+}
+
+}  // namespace graph
@@ -0,0 +1,125 @@
+#include "snapshot.h"
+
+namespace transport_catalogue {
+
+    using namespace std::literals;
+
+    Snapshot::Snapshot() :
+        catalogue_(&arena_),
+        router_(catalogue_)
+    {}
+
+    Snapshot::Snapshot(const Snapshot& other) :
+        catalogue_(other.catalogue_, &arena_),
+        router_(other.router_, catalogue_)
+    {
+        renderer_.SetSettings(other.renderer_.GetSettings());
+    }
+
+    TransportCatalogue& Snapshot::GetCatalogue() {
+        return catalogue_;
+    }
+
+    const TransportCatalogue& Snapshot::GetCatalogue() const {
+        return catalogue_;
+    }
+
+    renderer::MapRenderer& Snapshot::GetRenderer() {
+        return renderer_;
+    }
+
+    const renderer::MapRenderer& Snapshot::GetRenderer() const {
+        return renderer_;
+    }
+
+    transport_router::TransportRouter& Snapshot::GetRouter() {
+        return router_;
+    }
+
+    const transport_router::TransportRouter& Snapshot::GetRouter() const {
+        return router_;
+    }
+
+    void Snapshot::AddStop(const Stop& stop) {
+        if (catalogue_.FindStop(stop.name) != nullptr) {
+            throw std::invalid_argument("Stop "s + std::string(stop.name) + " already exists"s);
+        }
+        const bool is_frozen = catalogue_.IsFrozen();
+        catalogue_.AddStop(stop);
+        router_.AddStop(stop.name);
+        RestoreFrozen(is_frozen);
+    }
+
+    void Snapshot::RemoveStop(std::string_view stop_name) {
+        // Имя удалённой остановки остаётся в хранилище справочника
+        const std::string_view name = GetStop(stop_name)->name;
+        const bool is_frozen = catalogue_.IsFrozen();
+        // Справочник проверяет, что через остановку не ходят автобусы, до изменения маршрутизатора
+        catalogue_.RemoveStop(name);
+        router_.RemoveStop(name);
+        RestoreFrozen(is_frozen);
+    }
+
+    void Snapshot::SetStopCoordinates(std::string_view stop_name, Coordinates coordinates) {
+        const std::string_view name = GetStop(stop_name)->name;
+        catalogue_.SetStopCoordinates(name, coordinates);
+        router_.UpdateStopCoordinates(name);
+        renderer_.ResetCache();
+    }
+
+    void Snapshot::SetDistanceBetweenStops(std::string_view from, std::string_view to, int distance) {
+        const Stop* from_stop = GetStop(from);
+        const Stop* to_stop = GetStop(to);
+        catalogue_.SetDistanceBetweenStops(from_stop, to_stop, distance);
+        router_.UpdateDistance(from_stop->name, to_stop->name);
+    }
+
+    void Snapshot::AddBus(const Bus& bus) {
+        for (const Stop* stop : bus.stops) {
+            if (stop != catalogue_.FindStop(stop->name)) {
+                throw std::invalid_argument("Bus "s + std::string(bus.name) + " has a stop from another catalogue"s);
+            }
+        }
+        const bool is_frozen = catalogue_.IsFrozen();
+        if (catalogue_.FindBus(bus.name) != nullptr) {
+            catalogue_.RemoveBus(bus.name);
+        }
+        catalogue_.AddBus(bus);
+        router_.UpdateBus(bus.name);
+        renderer_.ResetCache();
+        RestoreFrozen(is_frozen);
+    }
+
+    void Snapshot::RemoveBus(std::string_view bus_name) {
+        // Имя удалённого автобуса остаётся в хранилище справочника
+        const std::string_view name = GetBus(bus_name)->name;
+        const bool is_frozen = catalogue_.IsFrozen();
+        catalogue_.RemoveBus(name);
+        router_.UpdateBus(name);
+        renderer_.ResetCache();
+        RestoreFrozen(is_frozen);
+    }
+
+    const Stop* Snapshot::GetStop(std::string_view stop_name) const {
+        const Stop* stop = catalogue_.FindStop(stop_name);
+        if (stop == nullptr) {
+            throw std::invalid_argument("Unknown stop "s + std::string(stop_name));
+        }
+        return stop;
+    }
+
+    const Bus* Snapshot::GetBus(std::string_view bus_name) const {
+        const Bus* bus = catalogue_.FindBus(bus_name);
+        if (bus == nullptr) {
+            throw std::invalid_argument("Unknown bus "s + std::string(bus_name));
+        }
+        return bus;
+    }
+
+    void Snapshot::RestoreFrozen(bool is_frozen) {
+        if (is_frozen && !catalogue_.IsFrozen()) {
+            catalogue_.Freeze();
+        }
+    }
+
+}  // namespace transport_catalogue
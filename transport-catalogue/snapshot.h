@@ -0,0 +1,226 @@
+#pragma once
+
+#include "transport_catalogue.h"
+#include "map_renderer.h"
+#include "transport_router.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace transport_catalogue {
+
+    // Версия справочника вместе с настроенными по ней отрисовщиком и маршрутизатором.
+    // Заполняется писателем до публикации, после публикации не изменяется
+    class Snapshot {
+    public:
+        Snapshot();
+
+        // Следующая версия: справочник копируется в свою арену, маршрутизатор переносится
+        // на копию без перестроения, отрисовщик получает те же настройки
+        Snapshot(const Snapshot& other);
+        Snapshot& operator=(const Snapshot&) = delete;
+
+        TransportCatalogue& GetCatalogue();
+        const TransportCatalogue& GetCatalogue() const;
+
+        renderer::MapRenderer& GetRenderer();
+        const renderer::MapRenderer& GetRenderer() const;
+
+        transport_router::TransportRouter& GetRouter();
+        const transport_router::TransportRouter& GetRouter() const;
+
+        // Изменяют ещё не опубликованную версию: справочник и маршрутизатор вместе,
+        // после чего справочник снова замораживается, если был заморожен.
+        // При ошибке версия остаётся прежней
+        void AddStop(const Stop& stop);
+        void RemoveStop(std::string_view stop_name);
+        void SetStopCoordinates(std::string_view stop_name, Coordinates coordinates);
+        void SetDistanceBetweenStops(std::string_view from, std::string_view to, int distance);
+        // Автобус с уже существующим именем заменяет прежний
+        void AddBus(const Bus& bus);
+        void RemoveBus(std::string_view bus_name);
+
+    private:
+        // Справочник версии не изменяется после публикации, поэтому его память берётся
+        // из арены без освобождения отдельных блоков и возвращается целиком вместе с версией
+        std::pmr::monotonic_buffer_resource arena_;
+        TransportCatalogue catalogue_;
+        renderer::MapRenderer renderer_;
+        transport_router::TransportRouter router_;
+
+        // Бросают std::invalid_argument, если имени нет в справочнике
+        const Stop* GetStop(std::string_view stop_name) const;
+        const Bus* GetBus(std::string_view bus_name) const;
+        void RestoreFrozen(bool is_frozen);
+    };
+
+    // Хранит текущую версию объекта в стиле RCU: читатели получают её без блокировок,
+    // писатель атомарно публикует следующую версию, а старые версии удаляются,
+    // когда их больше не читает ни один читатель
+    template <typename T>
+    class VersionedHandle {
+    public:
+        // Столько читателей могут одновременно удерживать версии, остальные ждут
+        static constexpr std::size_t READER_SLOTS = 128;
+
+        class ReadGuard {
+        public:
+            ReadGuard(const ReadGuard&) = delete;
+            ReadGuard& operator=(const ReadGuard&) = delete;
+
+            ~ReadGuard() {
+                slot_.store(FREE_SLOT);
+            }
+
+            const T& operator*() const {
+                return *value_;
+            }
+
+            const T* operator->() const {
+                return value_;
+            }
+
+            const T* Get() const {
+                return value_;
+            }
+
+        private:
+            friend class VersionedHandle;
+
+            ReadGuard(std::atomic<std::uint64_t>& slot, const T* value) :
+                slot_(slot), value_(value) {}
+
+            std::atomic<std::uint64_t>& slot_;
+            const T* value_;
+        };
+
+        VersionedHandle() = default;
+
+        VersionedHandle(const VersionedHandle&) = delete;
+        VersionedHandle& operator=(const VersionedHandle&) = delete;
+
+        ~VersionedHandle() {
+            delete current_.load();
+            for (auto& retired : retired_) {
+                delete retired.second;
+            }
+        }
+
+        // Закрепляет текущую версию на время жизни ReadGuard.
+        // Версия может быть пустой, если ещё ничего не опубликовано.
+        // Если заняты все слоты, ждёт, пока один из читателей не освободит свой
+        ReadGuard Acquire() const {
+            const std::size_t first = std::hash<std::thread::id>()(std::this_thread::get_id()) % READER_SLOTS;
+            for (std::size_t pass = 0;; ++pass) {
+                const std::uint64_t epoch = epoch_.load();
+                for (std::size_t i = 0; i < READER_SLOTS; ++i) {
+                    auto& slot = slots_[(first + i) % READER_SLOTS];
+                    std::uint64_t expected = FREE_SLOT;
+                    if (slot.compare_exchange_strong(expected, epoch)) {
+                        return ReadGuard(slot, current_.load());
+                    }
+                }
+                WaitForFreeSlot(pass);
+            }
+        }
+
+        // Публикует новую версию; предыдущая удаляется после ухода её читателей
+        void Publish(std::unique_ptr<const T> value) {
+            std::lock_guard guard(writer_mutex_);
+            const T* previous = current_.exchange(value.release());
+            const std::uint64_t retire_epoch = epoch_.fetch_add(1);
+            if (previous != nullptr) {
+                retired_.push_back({retire_epoch, previous});
+            }
+            ReclaimRetired();
+        }
+
+        // Удаляет версии, которые больше никто не читает
+        void Reclaim() {
+            std::lock_guard guard(writer_mutex_);
+            ReclaimRetired();
+        }
+
+        // Строит следующую версию из копии текущей: update изменяет копию, которую ещё
+        // никто не читает, после чего она публикуется. Обновления выполняются по очереди.
+        // Если update бросает исключение, текущая версия остаётся опубликованной
+        template <typename Function>
+        void Update(Function update) {
+            std::lock_guard guard(update_mutex_);
+            std::unique_ptr<T> next;
+            {
+                const ReadGuard current = Acquire();
+                if (current.Get() == nullptr) {
+                    throw std::logic_error("Nothing to update: no version is published");
+                }
+                next = std::make_unique<T>(*current);
+            }
+            update(*next);
+            Publish(std::move(next));
+        }
+
+        std::size_t GetRetiredCount() const {
+            std::lock_guard guard(writer_mutex_);
+            return retired_.size();
+        }
+
+    private:
+        static constexpr std::uint64_t FREE_SLOT = 0;
+        // После стольких проходов по занятым слотам читатель не уступает процессор, а засыпает
+        static constexpr std::size_t YIELD_PASSES = 16;
+        static constexpr std::chrono::microseconds MAX_SLOT_WAIT{1000};
+
+        std::atomic<const T*> current_ = nullptr;
+        // Эпохи начинаются с 1, так как 0 обозначает свободный слот
+        std::atomic<std::uint64_t> epoch_ = 1;
+        mutable std::array<std::atomic<std::uint64_t>, READER_SLOTS> slots_{};
+
+        mutable std::mutex writer_mutex_;
+        // Обновления держат его от копирования текущей версии до публикации следующей
+        std::mutex update_mutex_;
+        std::vector<std::pair<std::uint64_t, const T*>> retired_;
+
+        // Сначала уступает процессор читателям, которые держат слоты, затем спит всё дольше,
+        // чтобы ожидание не занимало ядро
+        static void WaitForFreeSlot(std::size_t pass) {
+            if (pass < YIELD_PASSES) {
+                std::this_thread::yield();
+                return;
+            }
+            const std::size_t shift = std::min<std::size_t>(pass - YIELD_PASSES, 10);
+            std::this_thread::sleep_for(std::min(std::chrono::microseconds(1 << shift), MAX_SLOT_WAIT));
+        }
+
+        // Версия, снятая с публикации в эпоху e, может читаться только читателями,
+        // закрепившимися в эпоху не позже e
+        void ReclaimRetired() {
+            std::uint64_t min_active_epoch = UINT64_MAX;
+            for (const auto& slot : slots_) {
+                const std::uint64_t epoch = slot.load();
+                if (epoch != FREE_SLOT && epoch < min_active_epoch) {
+                    min_active_epoch = epoch;
+                }
+            }
+            auto still_read = std::partition(retired_.begin(), retired_.end(), [min_active_epoch](const auto& retired) {
+                return retired.first >= min_active_epoch;
+            });
+            for (auto it = still_read; it != retired_.end(); ++it) {
+                delete it->second;
+            }
+            retired_.erase(still_read, retired_.end());
+        }
+    };
+
+}  // namespace transport_catalogue
@@ -0,0 +1,105 @@
+#include "stop_search.h"
+
+#include <algorithm>
+#include <queue>
+#include <tuple>
+
+namespace transport_catalogue {
+
+    bool IsBetterMatch(const StopMatch& lhs, const StopMatch& rhs) {
+        if (lhs.bus_count != rhs.bus_count) {
+            return lhs.bus_count > rhs.bus_count;
+        }
+        return lhs.name < rhs.name;
+    }
+
+    StopSearchIndex::StopSearchIndex(std::pmr::memory_resource* resource) :
+        stops_(resource), levels_(resource)
+    {}
+
+    void StopSearchIndex::Build(std::vector<StopMatch> stops) {
+        std::sort(stops.begin(), stops.end(), [](const StopMatch& lhs, const StopMatch& rhs) {
+            return lhs.name < rhs.name;
+        });
+        stops_.assign(stops.begin(), stops.end());
+        levels_.clear();
+        if (stops_.empty()) {
+            return;
+        }
+
+        auto& first = levels_.emplace_back(stops_.size());
+        for (std::size_t i = 0; i < stops_.size(); ++i) {
+            first[i] = static_cast<std::uint32_t>(i);
+        }
+        for (std::size_t width = 2; width <= stops_.size(); width *= 2) {
+            const auto& previous = levels_.back();
+            std::pmr::vector<std::uint32_t> level(stops_.size() - width + 1, levels_.get_allocator().resource());
+            for (std::size_t i = 0; i < level.size(); ++i) {
+                level[i] = GetBetter(previous[i], previous[i + width / 2]);
+            }
+            levels_.push_back(std::move(level));
+        }
+    }
+
+    void StopSearchIndex::Clear() {
+        stops_.clear();
+        levels_.clear();
+    }
+
+    std::vector<StopMatch> StopSearchIndex::Search(std::string_view prefix, std::size_t limit) const {
+        const auto begin = std::lower_bound(stops_.begin(), stops_.end(), prefix, [](const StopMatch& stop, std::string_view value) {
+            return stop.name < value;
+        });
+        const auto end = std::partition_point(begin, stops_.end(), [prefix](const StopMatch& stop) {
+            return stop.name.substr(0, prefix.size()) == prefix;
+        });
+
+        // Отрезки упорядочены по лучшей остановке: взятая остановка делит свой отрезок на два
+        using Range = std::tuple<std::uint32_t, std::size_t, std::size_t>;
+        auto is_worse = [this](const Range& lhs, const Range& rhs) {
+            return GetBetter(std::get<0>(lhs), std::get<0>(rhs)) == std::get<0>(rhs);
+        };
+        std::priority_queue<Range, std::vector<Range>, decltype(is_worse)> ranges(is_worse);
+        auto push_range = [this, &ranges](std::size_t range_begin, std::size_t range_end) {
+            if (range_begin < range_end) {
+                ranges.push({GetBest(range_begin, range_end), range_begin, range_end});
+            }
+        };
+        push_range(begin - stops_.begin(), end - stops_.begin());
+
+        std::vector<StopMatch> result;
+        while (result.size() < limit && !ranges.empty()) {
+            const auto [best, range_begin, range_end] = ranges.top();
+            ranges.pop();
+            result.push_back(stops_[best]);
+            push_range(range_begin, best);
+            push_range(best + 1, range_end);
+        }
+        return result;
+    }
+
+    std::size_t StopSearchIndex::GetMemoryUsage() const {
+        std::size_t bytes = stops_.capacity() * sizeof(StopMatch) + levels_.capacity() * sizeof(levels_.front());
+        for (const auto& level : levels_) {
+            bytes += level.capacity() * sizeof(std::uint32_t);
+        }
+        return bytes;
+    }
+
+    std::uint32_t StopSearchIndex::GetBetter(std::uint32_t lhs, std::uint32_t rhs) const {
+        // Имена отсортированы, поэтому при равном числе автобусов лучше меньший номер
+        if (stops_[lhs].bus_count != stops_[rhs].bus_count) {
+            return stops_[lhs].bus_count > stops_[rhs].bus_count ? lhs : rhs;
+        }
+        return std::min(lhs, rhs);
+    }
+
+    std::uint32_t StopSearchIndex::GetBest(std::size_t begin, std::size_t end) const {
+        std::size_t level = 0;
+        while ((std::size_t{2} << level) <= end - begin) {
+            ++level;
+        }
+        return GetBetter(levels_[level][begin], levels_[level][end - (std::size_t{1} << level)]);
+    }
+
+}  // namespace transport_catalogue
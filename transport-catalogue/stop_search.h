@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+namespace transport_catalogue {
+
+    struct StopMatch {
+        std::string_view name;
+        std::size_t bus_count = 0;
+    };
+
+    // Сначала остановки с большим числом автобусов, при равенстве — по алфавиту
+    bool IsBetterMatch(const StopMatch& lhs, const StopMatch& rhs);
+
+    // Индекс поиска остановок по началу названия. Имена отсортированы, поэтому остановки
+    // с общим префиксом занимают отрезок массива, который находится двоичным поиском.
+    // Лучшие остановки отрезка выбираются по разреженной таблице максимумов
+    // за O(limit * log limit), не перебирая весь отрезок
+    class StopSearchIndex {
+    public:
+        explicit StopSearchIndex(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+        void Build(std::vector<StopMatch> stops);
+        void Clear();
+
+        // Не более limit остановок, названия которых начинаются с prefix, в порядке IsBetterMatch
+        std::vector<StopMatch> Search(std::string_view prefix, std::size_t limit) const;
+
+        std::size_t GetMemoryUsage() const;
+
+    private:
+        // Остановки в порядке названий
+        std::pmr::vector<StopMatch> stops_;
+        // levels_[k][i] — номер лучшей остановки на отрезке [i, i + 2^k)
+        std::pmr::vector<std::pmr::vector<std::uint32_t>> levels_;
+
+        std::uint32_t GetBetter(std::uint32_t lhs, std::uint32_t rhs) const;
+        // Лучшая остановка на непустом отрезке [begin, end)
+        std::uint32_t GetBest(std::size_t begin, std::size_t end) const;
+    };
+
+}  // namespace transport_catalogue
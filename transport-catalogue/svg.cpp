@@ -132,11 +132,15 @@ namespace svg {
         out << "<text "sv;
         RenderAttrs(out);
         using detail::RenderAttr;
-        RenderAttr(out, " x"sv, position_.x);
-        RenderAttr(out, " y"sv, position_.y);
-        RenderAttr(out, " dx"sv, offset_.x);
-        RenderAttr(out, " dy"sv, offset_.y);
-        RenderAttr(out, " font-size"sv, font_size_);
+        if (position_) {
+            RenderAttr(out, " x"sv, position_->x);
+            RenderAttr(out, " y"sv, position_->y);
+        }
+        if (offset_) {
+            RenderAttr(out, " dx"sv, offset_->x);
+            RenderAttr(out, " dy"sv, offset_->y);
+        }
+        detail::RenderOptionalAttr(out, " font-size"sv, font_size_);
         if (!font_family_.empty()) {
             RenderAttr(out, " font-family"sv, font_family_);
         }
@@ -148,16 +152,107 @@ namespace svg {
         out << "</text>"sv;
     }
 
+// Use
+
+    Use& Use::SetHref(std::string id) {
+        href_ = std::move(id);
+        return *this;
+    }
+
+    Use& Use::SetPosition(Point pos) {
+        position_ = pos;
+        return *this;
+    }
+
+    void Use::RenderObject(const RenderContext& context) const {
+        auto& out = context.out;
+        out << "<use xlink:href=\"#"sv;
+        detail::HtmlEncodeString(out, href_);
+        out << "\" x=\""sv << position_.x << "\" y=\""sv << position_.y << "\" "sv;
+        RenderAttrs(out);
+        out << "/>"sv;
+    }
+
+// Fragment
+
+    void Fragment::AddPtr(std::unique_ptr<Object>&& obj) {
+        has_links_ = has_links_ || obj->HasLinks();
+        obj->RenderObject(RenderContext{text_});
+        ends_.push_back(static_cast<std::size_t>(text_.tellp()));
+    }
+
+    bool Fragment::Empty() const {
+        return ends_.empty();
+    }
+
+    // Отступ перед первым объектом и перевод строки после последнего выводит Object::Render
+    void Fragment::RenderObject(const RenderContext& context) const {
+        const std::string text = text_.str();
+        std::size_t begin = 0;
+        bool first = true;
+        for (std::size_t end : ends_) {
+            if (first) {
+                first = false;
+            } else {
+                context.out.put('\n');
+                context.RenderIndent();
+            }
+            context.out.write(text.data() + begin, static_cast<std::streamsize>(end - begin));
+            begin = end;
+        }
+    }
+
+// Definitions
+
+    void Definitions::AddPtr(std::unique_ptr<Object>&& obj) {
+        objects_.push_back(std::move(obj));
+    }
+
+    void Definitions::Render(const RenderContext& context) const {
+        context.RenderIndent();
+        context.out << "<defs>"sv << std::endl;
+        const auto inner_context = context.Indented();
+        for (const auto& obj : objects_) {
+            obj->Render(inner_context);
+        }
+        context.RenderIndent();
+        context.out << "</defs>"sv << std::endl;
+    }
+
+    bool Definitions::Empty() const {
+        return objects_.empty();
+    }
+
 // Document
 
     void Document::AddPtr(std::unique_ptr<Object>&& obj) {
+        has_links_ = has_links_ || obj->HasLinks();
         objects_.push_back(std::move(obj));
     }
 
+    void Document::SetStyleSheet(std::string style_sheet) {
+        style_sheet_ = std::move(style_sheet);
+    }
+
+    Definitions& Document::GetDefinitions() {
+        return definitions_;
+    }
+
     void Document::Render(std::ostream& out) const {
         out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"sv << std::endl;
-        out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">"sv << std::endl;
+        out << "<svg xmlns=\"http://www.w3.org/2000/svg\" "sv;
+        if (has_links_) {
+            out << "xmlns:xlink=\"http://www.w3.org/1999/xlink\" "sv;
+        }
+        out << "version=\"1.1\">"sv << std::endl;
         RenderContext ctx{out, 2, 2};
+        if (!style_sheet_.empty()) {
+            ctx.RenderIndent();
+            out << "<style>"sv << style_sheet_ << "</style>"sv << std::endl;
+        }
+        if (!definitions_.Empty()) {
+            definitions_.Render(ctx);
+        }
         for (const auto& obj : objects_) {
             obj->Render(ctx);
         }
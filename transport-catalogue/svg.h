@@ -4,6 +4,7 @@
 #include <iostream>
 #include <memory>
 #include <optional>
+#include <sstream>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -100,9 +101,17 @@ namespace detail {
     public:
         void Render(const RenderContext& context) const;
 
+        // Объект ссылается на другие через xlink:href, и документ должен объявить пространство имён xlink
+        virtual bool HasLinks() const {
+            return false;
+        }
+
         virtual ~Object() = default;
 
     private:
+        // Фрагмент выводит объекты без отступа и перевода строки
+        friend class Fragment;
+
         virtual void RenderObject(const RenderContext& context) const = 0;
     };
 
@@ -127,6 +136,16 @@ namespace detail {
     template <typename Owner>
     class PathProps {
     public:
+        // Задаёт идентификатор объекта (атрибут id)
+        Owner& SetId(std::string id) {
+            id_ = std::move(id);
+            return AsOwner();
+        }
+        // Задаёт CSS-классы объекта (атрибут class)
+        Owner& SetClass(std::string class_name) {
+            class_ = std::move(class_name);
+            return AsOwner();
+        }
         Owner& SetFillColor(Color color) {
             fill_color_ = std::move(color);
             return AsOwner();
@@ -152,13 +171,24 @@ namespace detail {
         ~PathProps() = default;
 
         void RenderAttrs(std::ostream& out) const {
-            using detail::RenderOptionalAttr;
             using namespace std::literals;
-            RenderOptionalAttr(out, "fill"sv, fill_color_);
-            RenderOptionalAttr(out, " stroke"sv, stroke_color_);
-            RenderOptionalAttr(out, " stroke-width"sv, stroke_width_);
-            RenderOptionalAttr(out, " stroke-linecap"sv, stroke_line_cap_);
-            RenderOptionalAttr(out, " stroke-linejoin"sv, stroke_line_join_);
+            bool first = true;
+            auto render_attr = [&out, &first](std::string_view name, const auto& value) {
+                if (value) {
+                    if (!first) {
+                        out.put(' ');
+                    }
+                    first = false;
+                    detail::RenderAttr(out, name, *value);
+                }
+            };
+            render_attr("id"sv, id_);
+            render_attr("class"sv, class_);
+            render_attr("fill"sv, fill_color_);
+            render_attr("stroke"sv, stroke_color_);
+            render_attr("stroke-width"sv, stroke_width_);
+            render_attr("stroke-linecap"sv, stroke_line_cap_);
+            render_attr("stroke-linejoin"sv, stroke_line_join_);
         }
 
     private:
@@ -168,6 +198,8 @@ namespace detail {
             return static_cast<Owner&>(*this);
         }
 
+        std::optional<std::string> id_;
+        std::optional<std::string> class_;
         std::optional<Color> fill_color_;
         std::optional<Color> stroke_color_;
         std::optional<double> stroke_width_;
@@ -222,15 +254,36 @@ namespace detail {
 
     private:
         void RenderObject(const RenderContext& context) const override;
-        Point position_;
-        Point offset_;
-        uint32_t font_size_ = 1;
+        // Незаданные координаты, смещение и размер шрифта не выводятся
+        std::optional<Point> position_;
+        std::optional<Point> offset_;
+        std::optional<uint32_t> font_size_;
         std::string font_family_;
         std::string font_weight_;
         std::string data_;
     };
 
 
+    // Ссылка на объект из секции <defs> (тэг use)
+    class Use : public Object, public PathProps<Use> {
+    public:
+        // Задаёт идентификатор объекта, на который ссылается use
+        Use& SetHref(std::string id);
+
+        // Задаёт смещение копии объекта (атрибуты x и y)
+        Use& SetPosition(Point pos);
+
+        bool HasLinks() const override {
+            return true;
+        }
+
+    private:
+        void RenderObject(const RenderContext& context) const override;
+        std::string href_;
+        Point position_;
+    };
+
+
     // Интерфейс, представляющий контейнер SVG объектов.
     class ObjectContainer {
     public:
@@ -261,16 +314,60 @@ namespace detail {
         virtual ~Drawable() = default;
     };
 
+    // Объекты, выведенные в текст сразу при добавлении. Фрагменты можно заполнять в разных
+    // потоках и затем добавить в документ по порядку: вывод совпадает с выводом самих объектов.
+    // Пустой фрагмент выводится как пустая строка, поэтому в документ его не добавляют
+    class Fragment : public Object, public ObjectContainer {
+    public:
+        void AddPtr(std::unique_ptr<Object>&& obj) override;
+
+        bool Empty() const;
+
+        bool HasLinks() const override {
+            return has_links_;
+        }
+
+    private:
+        void RenderObject(const RenderContext& context) const override;
+
+        std::ostringstream text_;
+        bool has_links_ = false;
+        // Концы текстов объектов в text_
+        std::vector<std::size_t> ends_;
+    };
+
+    // Объекты секции <defs>, на которые ссылаются тэги use
+    class Definitions : public ObjectContainer {
+    public:
+        void AddPtr(std::unique_ptr<Object>&& obj) override;
+
+        void Render(const RenderContext& context) const;
+
+        bool Empty() const;
+
+    private:
+        std::vector<std::unique_ptr<Object>> objects_;
+    };
+
     class Document : public ObjectContainer {
     public:
         // Добавляет в svg-документ объект-наследник svg::Object
         void AddPtr(std::unique_ptr<Object>&& obj) override;
 
+        // Задаёт таблицу стилей, выводимую в тэге style
+        void SetStyleSheet(std::string style_sheet);
+
+        Definitions& GetDefinitions();
+
         // Выводит в ostream svg-представление документа
         void Render(std::ostream& out) const;
 
     private:
+        std::string style_sheet_;
+        Definitions definitions_;
         std::vector<std::unique_ptr<Object>> objects_;
+        // Пространство имён xlink объявляется, только если его используют объекты документа
+        bool has_links_ = false;
     };
 
 }  // namespace svg
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include "tests.h"
+#include "test_framework.h"
+#include "../json.h"
+
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+    // Размер куска индекса и порог параллельного разбора массива из json.cpp
+    constexpr std::size_t MIN_CHUNK_SIZE = 1 << 16;
+    constexpr std::size_t MIN_PARALLEL_ARRAY_SIZE = 64;
+
+    const std::vector<std::size_t> THREAD_COUNTS = {1, 2, 4, 8};
+
+    // Пусто, если разбор завершился ошибкой
+    std::optional<json::Document> TryLoad(const std::string& text) {
+        std::istringstream input(text);
+        try {
+            return json::Load(input);
+        } catch (const json::ParsingError&) {
+            return std::nullopt;
+        }
+    }
+
+    std::optional<json::Document> TryLoadParallel(const std::string& text, std::size_t thread_count) {
+        try {
+            return json::LoadParallel(text, thread_count);
+        } catch (const json::ParsingError&) {
+            return std::nullopt;
+        }
+    }
+
+    void AssertSameAsLoad(const std::string& text, std::size_t thread_count, const std::string& hint) {
+        const auto expected = TryLoad(text);
+        const auto actual = TryLoadParallel(text, thread_count);
+        const auto full_hint = hint + ", threads "s + std::to_string(thread_count);
+        ASSERT_EQUAL_HINT(actual.has_value(), expected.has_value(), full_hint);
+        if (expected) {
+            ASSERT_HINT(*actual == *expected, full_hint);
+        }
+    }
+
+    // Строки с экранированием, кавычками и структурными символами внутри
+    const std::vector<std::string> STRINGS = {
+        R"("a\"b")", R"("\\")", R"("\\\"")", R"("x\\\\")", R"("\n\t\r")", R"("[{,:}]")", R"("\"\"")", R"("")",
+    };
+
+    // Тело документа повторяется с периодом в STRINGS.size() элементов. При сдвигах на два периода
+    // границы кусков индекса попадают на каждый символ периода, в том числе внутрь экранирования.
+    // Число кусков от числа потоков тут не зависит, поэтому потоки чередуются
+    void TestEscapesAcrossChunkBoundaries() {
+        auto make_item = [](std::size_t i) {
+            return i % STRINGS.size() == 0
+                ? "{"s + STRINGS[i % STRINGS.size()] + ":"s + STRINGS[(i + 1) % STRINGS.size()] + "}"s
+                : STRINGS[i % STRINGS.size()];
+        };
+        std::size_t period = 0;
+        for (std::size_t i = 0; i < STRINGS.size(); ++i) {
+            period += make_item(i).size() + 1;
+        }
+        std::string body = "[";
+        for (std::size_t i = 0; body.size() < 3 * MIN_CHUNK_SIZE; ++i) {
+            body += (i > 0 ? ","s : ""s) + make_item(i);
+        }
+        body += ']';
+
+        for (std::size_t shift = 0; shift < 2 * period; ++shift) {
+            const std::string text = std::string(shift, ' ') + body;
+            AssertSameAsLoad(text, shift % 2 == 0 ? 1 : 4, "shift "s + std::to_string(shift));
+        }
+    }
+
+    void TestArraysAroundParallelThreshold() {
+        for (const std::size_t size : {std::size_t{0}, std::size_t{1}, MIN_PARALLEL_ARRAY_SIZE - 1,
+                                       MIN_PARALLEL_ARRAY_SIZE, MIN_PARALLEL_ARRAY_SIZE + 1, 4 * MIN_PARALLEL_ARRAY_SIZE}) {
+            std::string numbers;
+            std::string dicts;
+            for (std::size_t i = 0; i < size; ++i) {
+                numbers += (i > 0 ? ", "s : ""s) + std::to_string(i) + (i % 2 == 0 ? ".5"s : ""s);
+                dicts += (i > 0 ? ","s : ""s) + "{\"a\": ["s + std::to_string(i) + ", "s + STRINGS[i % STRINGS.size()]
+                    + "], \"b\": {\"c\": null}}"s;
+            }
+            const std::vector<std::string> texts = {
+                "["s + numbers + "]"s,
+                "["s + dicts + "]"s,
+                "{\"base_requests\": ["s + dicts + "], \"stat_requests\": ["s + numbers + "]}"s,
+                "[["s + numbers + "], ["s + dicts + "]]"s,
+            };
+            for (std::size_t text = 0; text < texts.size(); ++text) {
+                for (const std::size_t thread_count : THREAD_COUNTS) {
+                    AssertSameAsLoad(texts[text], thread_count,
+                                     "size "s + std::to_string(size) + ", text "s + std::to_string(text));
+                }
+            }
+        }
+    }
+
+    std::string MakeLargeArray(std::size_t size, std::size_t broken_item, const std::string& broken) {
+        std::string text = "[";
+        for (std::size_t i = 0; i < size; ++i) {
+            text += i == broken_item ? broken : (i > 0 ? ","s : ""s) + "{\"a\":"s + std::to_string(i) + "}"s;
+        }
+        return text + "]"s;
+    }
+
+    // Ошибки, на которых останавливаются оба разбора
+    void TestMalformedInput() {
+        const std::vector<std::string> texts = {
+            ""s, "   "s, "["s, "{"s, "[1, 2"s, R"({"a": 1)"s, R"({"a" 1})"s, R"({"a": })"s, R"({1: 2})"s,
+            R"(["abc)"s, R"(["a\qb"])"s, "[\"a\nb\"]"s, "[tru]"s, "[nul]"s, "[-]"s, "[1.]"s, "[1e]"s,
+            R"({"a": 1, "a": 2})"s, "[}"s, "{]"s, "]"s, "}"s,
+            MakeLargeArray(2 * MIN_PARALLEL_ARRAY_SIZE, 70, ",{\"a\":"s),
+            MakeLargeArray(2 * MIN_PARALLEL_ARRAY_SIZE, 70, ",[\"x"s),
+            MakeLargeArray(2 * MIN_PARALLEL_ARRAY_SIZE, 2 * MIN_PARALLEL_ARRAY_SIZE - 1, ",{\"a\" 1}"s),
+        };
+        for (std::size_t text = 0; text < texts.size(); ++text) {
+            for (const std::size_t thread_count : THREAD_COUNTS) {
+                const auto hint = "text "s + std::to_string(text);
+                ASSERT_HINT(!TryLoad(texts[text]), hint);
+                AssertSameAsLoad(texts[text], thread_count, hint);
+            }
+        }
+    }
+
+    // Load пропускает недостающие запятые и не читает дальше корня, LoadParallel принимает только
+    // корректный документ и пробелы после него
+    void TestParallelRejectsWhatLoadTolerates() {
+        const std::vector<std::string> texts = {
+            R"({"a": 1}})"s, R"({"a": 1} {"b": 2})"s, "[1 2]"s, R"({"a": 1 "b": 2})"s,
+            MakeLargeArray(2 * MIN_PARALLEL_ARRAY_SIZE, 70, "{\"a\":70}"s),
+        };
+        for (std::size_t text = 0; text < texts.size(); ++text) {
+            for (const std::size_t thread_count : THREAD_COUNTS) {
+                const auto hint = "text "s + std::to_string(text) + ", threads "s + std::to_string(thread_count);
+                ASSERT_HINT(TryLoad(texts[text]).has_value(), hint);
+                ASSERT_HINT(!TryLoadParallel(texts[text], thread_count), hint);
+            }
+        }
+        ASSERT(TryLoadParallel("{\"a\": 1}\n \t\r\n"s, 4).has_value());
+    }
+
+    class RandomDocument {
+    public:
+        explicit RandomDocument(std::mt19937& generator) :
+            generator_(generator) {}
+
+        std::string Make() {
+            return Pick(2) == 0 ? MakeArray(0) : MakeDict(0);
+        }
+
+    private:
+        std::mt19937& generator_;
+
+        std::size_t Pick(std::size_t count) {
+            return std::uniform_int_distribution<std::size_t>(0, count - 1)(generator_);
+        }
+
+        std::string Space() {
+            static const std::vector<std::string> spaces = {""s, " "s, "\n"s, "\t "s};
+            return spaces[Pick(spaces.size())];
+        }
+
+        std::string MakeValue(int depth) {
+            static const std::vector<std::string> scalars = {
+                "0"s, "-12"s, "3.25"s, "1e3"s, "2.5E-2"s, "-0.125"s, "2147483647"s, "true"s, "false"s, "null"s,
+            };
+            switch (depth < 3 ? Pick(4) : Pick(2)) {
+                case 0:
+                    return scalars[Pick(scalars.size())];
+                case 1:
+                    return STRINGS[Pick(STRINGS.size())];
+                case 2:
+                    return MakeArray(depth + 1);
+                default:
+                    return MakeDict(depth + 1);
+            }
+        }
+
+        // Иногда массив длиннее порога параллельного разбора
+        std::size_t PickSize() {
+            return Pick(8) == 0 ? MIN_PARALLEL_ARRAY_SIZE - 2 + Pick(5) : Pick(6);
+        }
+
+        std::string MakeArray(int depth) {
+            std::string text = "["s + Space();
+            for (std::size_t i = 0, size = PickSize(); i < size; ++i) {
+                text += (i > 0 ? ","s + Space() : ""s) + MakeValue(depth) + Space();
+            }
+            return text + "]"s;
+        }
+
+        std::string MakeDict(int depth) {
+            std::string text = "{"s + Space();
+            for (std::size_t i = 0, size = PickSize(); i < size; ++i) {
+                text += (i > 0 ? ","s + Space() : ""s) + "\"k\\\""s + std::to_string(i) + "\""s + Space() + ":"s
+                    + Space() + MakeValue(depth) + Space();
+            }
+            return text + "}"s;
+        }
+    };
+
+    // Обрезанный документ не закрывает корень, поэтому ошибкой заканчиваются оба разбора
+    void TestRandomDocuments() {
+        std::mt19937 generator(49);
+        for (int document = 0; document < 300; ++document) {
+            const std::string text = RandomDocument(generator).Make();
+            const std::size_t thread_count = THREAD_COUNTS[document % THREAD_COUNTS.size()];
+            const auto hint = "document "s + std::to_string(document);
+            ASSERT_HINT(TryLoad(text).has_value(), hint);
+            AssertSameAsLoad(text, thread_count, hint);
+            const std::size_t cut = std::uniform_int_distribution<std::size_t>(0, text.size() - 1)(generator);
+            AssertSameAsLoad(text.substr(0, cut), thread_count, hint + ", cut "s + std::to_string(cut));
+        }
+    }
+
+}  // namespace
+
+void TestJson() {
+    RUN_TEST(TestEscapesAcrossChunkBoundaries);
+    RUN_TEST(TestArraysAroundParallelThreshold);
+    RUN_TEST(TestMalformedInput);
+    RUN_TEST(TestParallelRejectsWhatLoadTolerates);
+    RUN_TEST(TestRandomDocuments);
+}
@@ -0,0 +1,14 @@
+#include "tests.h"
+
+#include <iostream>
+
+int main() {
+    TestTransportCatalogue();
+    TestTransportRouter();
+    TestSvg();
+    TestMapRenderer();
+    TestShortestPathTree();
+    TestSnapshot();
+    TestJson();
+    std::cerr << "All tests passed" << std::endl;
+}
@@ -0,0 +1,168 @@
+#include "tests.h"
+#include "test_framework.h"
+#include "../map_renderer.h"
+#include "../snapshot.h"
+
+#include <sstream>
+#include <string>
+
+using namespace std::literals;
+using namespace transport_catalogue;
+
+namespace {
+
+    constexpr int LINE_STOP_COUNT = 20;
+    // Больше нескольких частей по MIN_STOP_SLICE_SIZE остановок
+    constexpr int GRID_SIZE = 32;
+
+    renderer::RenderSettings MakeSettings(double simplify_tolerance) {
+        renderer::RenderSettings settings;
+        settings.width = 600;
+        settings.height = 400;
+        settings.padding = 50;
+        settings.line_width = 14;
+        settings.stop_radius = 5;
+        settings.bus_label_font_size = 20;
+        settings.bus_label_offset[0] = 7;
+        settings.bus_label_offset[1] = 15;
+        settings.stop_label_font_size = 18;
+        settings.stop_label_offset[0] = 7;
+        settings.stop_label_offset[1] = -3;
+        settings.underlayer_color = "white"s;
+        settings.color_palette = {"green"s, "red"s};
+        settings.simplify_tolerance = simplify_tolerance;
+        return settings;
+    }
+
+    // Автобус 1 едет по почти прямой линии, которую упрощение сводит к концам,
+    // автобус 2 задаёт границы карты
+    void FillCatalogue(TransportCatalogue& catalogue) {
+        std::pmr::vector<const Stop*> line;
+        for (int i = 0; i < LINE_STOP_COUNT; ++i) {
+            catalogue.AddStop({"L"s + std::to_string(i), {55.1 + (i % 2) * 0.0001, 37.01 + 0.02 * i}});
+            line.push_back(catalogue.FindStop("L"s + std::to_string(i)));
+            if (i > 0) {
+                catalogue.SetDistanceBetweenStops(line[i - 1], line[i], 1300);
+            }
+        }
+        catalogue.AddStop({"C0"sv, {55.0, 37.0}});
+        catalogue.AddStop({"C1"sv, {55.2, 37.4}});
+        catalogue.SetDistanceBetweenStops(catalogue.FindStop("C0"sv), catalogue.FindStop("C1"sv), 35000);
+        catalogue.AddBus({"1"sv, line, true});
+        catalogue.AddBus({"2"sv, std::pmr::vector<const Stop*>{catalogue.FindStop("C0"sv), catalogue.FindStop("C1"sv)}, false});
+    }
+
+    std::string Render(const renderer::MapRenderer& renderer, const std::pmr::deque<Bus>& buses) {
+        std::ostringstream out;
+        renderer.Render(buses).Render(out);
+        return out.str();
+    }
+
+    std::string RenderFresh(const renderer::RenderSettings& settings, const std::pmr::deque<Bus>& buses) {
+        renderer::MapRenderer renderer;
+        renderer.SetSettings(settings);
+        return Render(renderer, buses);
+    }
+
+    void TestCachedRoutesMatchFreshRender() {
+        TransportCatalogue catalogue;
+        FillCatalogue(catalogue);
+        renderer::MapRenderer renderer;
+        renderer.SetSettings(MakeSettings(5.0));
+
+        const std::string first = Render(renderer, catalogue.GetBuses());
+        ASSERT_EQUAL(Render(renderer, catalogue.GetBuses()), first);
+        ASSERT_EQUAL(first, RenderFresh(MakeSettings(5.0), catalogue.GetBuses()));
+        ASSERT(first != RenderFresh(MakeSettings(0.0), catalogue.GetBuses()));
+    }
+
+    // Без автобуса 2 границы карты, а с ними и проекция, другие
+    void TestProjectionChangeInvalidatesCache() {
+        TransportCatalogue catalogue;
+        FillCatalogue(catalogue);
+        renderer::MapRenderer renderer;
+        renderer.SetSettings(MakeSettings(5.0));
+        Render(renderer, catalogue.GetBuses());
+
+        std::pmr::deque<Bus> line_only;
+        line_only.push_back(*catalogue.FindBus("1"sv));
+        ASSERT_EQUAL(Render(renderer, line_only), RenderFresh(MakeSettings(5.0), line_only));
+        ASSERT_EQUAL(Render(renderer, catalogue.GetBuses()), RenderFresh(MakeSettings(5.0), catalogue.GetBuses()));
+    }
+
+    void TestSettingsChangeInvalidatesCache() {
+        TransportCatalogue catalogue;
+        FillCatalogue(catalogue);
+        renderer::MapRenderer renderer;
+        renderer.SetSettings(MakeSettings(5.0));
+        Render(renderer, catalogue.GetBuses());
+
+        renderer.SetSettings(MakeSettings(0.01));
+        ASSERT_EQUAL(Render(renderer, catalogue.GetBuses()), RenderFresh(MakeSettings(0.01), catalogue.GetBuses()));
+    }
+
+    // Новые координаты остановки внутри карты проекцию не меняют
+    void TestStopCoordinatesInvalidateCache() {
+        Snapshot snapshot;
+        FillCatalogue(snapshot.GetCatalogue());
+        snapshot.GetCatalogue().Freeze();
+        snapshot.GetRenderer().SetSettings(MakeSettings(5.0));
+        snapshot.GetRouter().SetSettingsAndBuild({2, 30});
+        const std::string before = Render(snapshot.GetRenderer(), snapshot.GetCatalogue().GetBuses());
+
+        snapshot.SetStopCoordinates("L10"sv, {55.18, 37.21});
+        const std::string after = Render(snapshot.GetRenderer(), snapshot.GetCatalogue().GetBuses());
+        ASSERT(after != before);
+        ASSERT_EQUAL(after, RenderFresh(MakeSettings(5.0), snapshot.GetCatalogue().GetBuses()));
+    }
+
+    // Сетка из GRID_SIZE * GRID_SIZE остановок: автобусы по строкам и столбцам
+    void FillGrid(TransportCatalogue& catalogue) {
+        auto name = [](int row, int column) {
+            return "G"s + std::to_string(row) + "_"s + std::to_string(column);
+        };
+        for (int row = 0; row < GRID_SIZE; ++row) {
+            for (int column = 0; column < GRID_SIZE; ++column) {
+                catalogue.AddStop({name(row, column), {55.0 + 0.01 * row, 37.0 + 0.01 * column}});
+            }
+        }
+        for (int i = 0; i < GRID_SIZE; ++i) {
+            std::pmr::vector<const Stop*> row;
+            std::pmr::vector<const Stop*> column;
+            for (int j = 0; j < GRID_SIZE; ++j) {
+                row.push_back(catalogue.FindStop(name(i, j)));
+                column.push_back(catalogue.FindStop(name(j, i)));
+                if (j > 0) {
+                    catalogue.SetDistanceBetweenStops(row[j - 1], row[j], 700);
+                    catalogue.SetDistanceBetweenStops(column[j - 1], column[j], 700);
+                }
+            }
+            catalogue.AddBus({"R"s + std::to_string(i), row, false});
+            catalogue.AddBus({"C"s + std::to_string(i), column, false});
+        }
+    }
+
+    void TestParallelRenderMatchesSequential() {
+        TransportCatalogue catalogue;
+        FillCatalogue(catalogue);
+        FillGrid(catalogue);
+        for (const bool compact_output : {false, true}) {
+            renderer::RenderSettings settings = MakeSettings(0.0);
+            settings.compact_output = compact_output;
+            settings.render_threads = 1;
+            const std::string sequential = RenderFresh(settings, catalogue.GetBuses());
+            settings.render_threads = 8;
+            ASSERT_EQUAL_HINT(RenderFresh(settings, catalogue.GetBuses()), sequential,
+                              compact_output ? "compact"s : "normal"s);
+        }
+    }
+
+}  // namespace
+
+void TestMapRenderer() {
+    RUN_TEST(TestCachedRoutesMatchFreshRender);
+    RUN_TEST(TestProjectionChangeInvalidatesCache);
+    RUN_TEST(TestSettingsChangeInvalidatesCache);
+    RUN_TEST(TestStopCoordinatesInvalidateCache);
+    RUN_TEST(TestParallelRenderMatchesSequential);
+}
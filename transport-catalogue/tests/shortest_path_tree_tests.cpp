@@ -0,0 +1,55 @@
+#include "tests.h"
+#include "test_framework.h"
+#include "../shortest_path_tree.h"
+
+using namespace graph;
+
+namespace {
+
+    DirectedWeightedGraph<double> MakeChain(size_t vertex_count) {
+        DirectedWeightedGraph<double> graph(vertex_count);
+        for (VertexId vertex = 0; vertex + 1 < vertex_count; ++vertex) {
+            graph.AddEdge({vertex, vertex + 1, 1.0});
+        }
+        return graph;
+    }
+
+    // Кэш на несколько деревьев не делится на сегменты меньше дерева
+    void TestCacheKeepsTreesLargerThanDefaultShard() {
+        const auto graph = MakeChain(1000);
+        const size_t tree_bytes = ShortestPathTree<double>::GetMemoryUsage(graph.GetVertexCount());
+        ShortestPathTreeCache<double> cache(3 * tree_bytes, graph.GetVertexCount());
+
+        for (VertexId source = 0; source < 3; ++source) {
+            ASSERT_EQUAL(cache.Get(graph, source)->GetMemoryUsage(), tree_bytes);
+        }
+        for (VertexId source = 0; source < 3; ++source) {
+            cache.Get(graph, source);
+        }
+        const auto stats = cache.GetStats();
+        ASSERT_EQUAL(stats.misses, 3u);
+        ASSERT_EQUAL(stats.hits, 3u);
+        ASSERT_EQUAL(stats.trees, 3u);
+        ASSERT_EQUAL(stats.oversized, 0u);
+    }
+
+    void TestCacheReportsOversizedTrees() {
+        const auto graph = MakeChain(1000);
+        const size_t tree_bytes = ShortestPathTree<double>::GetMemoryUsage(graph.GetVertexCount());
+        ShortestPathTreeCache<double> cache(tree_bytes / 2, graph.GetVertexCount());
+
+        const auto tree = cache.Get(graph, 0);
+        ASSERT_EQUAL(*tree->GetWeight(999), 999.0);
+        cache.Get(graph, 0);
+        const auto stats = cache.GetStats();
+        ASSERT_EQUAL(stats.misses, 2u);
+        ASSERT_EQUAL(stats.trees, 0u);
+        ASSERT_EQUAL(stats.oversized, 2u);
+    }
+
+}  // namespace
+
+void TestShortestPathTree() {
+    RUN_TEST(TestCacheKeepsTreesLargerThanDefaultShard);
+    RUN_TEST(TestCacheReportsOversizedTrees);
+}
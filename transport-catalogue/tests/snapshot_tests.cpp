@@ -0,0 +1,352 @@
+#include "tests.h"
+#include "test_framework.h"
+#include "../snapshot.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::literals;
+using namespace transport_catalogue;
+using namespace transport_router;
+
+namespace {
+
+    // Версия, которая знает, сколько её копий живо, и замечает чтение после удаления
+    struct Version {
+        explicit Version(int value) : value(value), check(value) {
+            ++alive;
+        }
+
+        ~Version() {
+            check = -1;
+            --alive;
+        }
+
+        int value;
+        int check;
+
+        static inline std::atomic<int> alive = 0;
+    };
+
+    // ReadGuard нельзя перемещать, поэтому удерживаемые версии хранятся в обёртке
+    struct Reader {
+        explicit Reader(const VersionedHandle<Version>& handle) :
+            guard(handle.Acquire()) {}
+
+        VersionedHandle<Version>::ReadGuard guard;
+    };
+
+    void TestAcquireWaitsForFreeSlot() {
+        VersionedHandle<Version> handle;
+        handle.Publish(std::make_unique<Version>(1));
+        std::deque<Reader> readers;
+        for (std::size_t i = 0; i < VersionedHandle<Version>::READER_SLOTS; ++i) {
+            readers.emplace_back(handle);
+        }
+
+        std::atomic<bool> acquired = false;
+        std::thread waiting([&handle, &acquired] {
+            const auto guard = handle.Acquire();
+            acquired = guard->value == 1;
+        });
+        std::this_thread::sleep_for(20ms);
+        ASSERT(!acquired);
+        readers.pop_back();
+        waiting.join();
+        ASSERT(acquired);
+    }
+
+    void TestConcurrentPublishAndReclaim() {
+        constexpr int VERSIONS = 2000;
+        constexpr int READERS = 4;
+        {
+            VersionedHandle<Version> handle;
+            handle.Publish(std::make_unique<Version>(0));
+
+            std::atomic<bool> done = false;
+            std::atomic<int> errors = 0;
+            std::vector<std::thread> readers;
+            for (int i = 0; i < READERS; ++i) {
+                readers.emplace_back([&] {
+                    int last_value = 0;
+                    while (!done) {
+                        const auto guard = handle.Acquire();
+                        // Версии публикуются по возрастанию, и читатель не должен увидеть удалённую
+                        if (guard->check != guard->value || guard->value < last_value) {
+                            ++errors;
+                        }
+                        last_value = guard->value;
+                    }
+                });
+            }
+            for (int value = 1; value <= VERSIONS; ++value) {
+                handle.Publish(std::make_unique<Version>(value));
+                if (value % 16 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+            done = true;
+            for (auto& reader : readers) {
+                reader.join();
+            }
+
+            ASSERT_EQUAL(errors.load(), 0);
+            handle.Reclaim();
+            ASSERT_EQUAL(handle.GetRetiredCount(), 0u);
+            ASSERT_EQUAL(Version::alive.load(), 1);
+            ASSERT_EQUAL(handle.Acquire()->value, VERSIONS);
+        }
+        ASSERT_EQUAL(Version::alive.load(), 0);
+    }
+
+    // Описание сети по именам, из которого справочник строится с нуля
+    struct Network {
+        struct BusRoute {
+            std::vector<std::string> stops;
+            bool is_roundtrip;
+        };
+
+        std::map<std::string, Coordinates> stops;
+        std::map<std::pair<std::string, std::string>, int> distances;
+        std::map<std::string, BusRoute> buses;
+    };
+
+    Network MakeNetwork(std::mt19937& generator) {
+        std::uniform_real_distribution<double> offset(0.0, 0.02);
+        std::uniform_int_distribution<int> distance(800, 3000);
+        Network network;
+        std::vector<std::string> names;
+        for (int i = 0; i < 14; ++i) {
+            names.push_back("S"s + std::to_string(i));
+            network.stops[names.back()] = {55.6 + offset(generator), 37.6 + offset(generator)};
+        }
+        for (int bus = 0; bus < 5; ++bus) {
+            Network::BusRoute route{{}, bus % 2 == 0};
+            for (int i = 0; i < 5; ++i) {
+                route.stops.push_back(names[(bus * 3 + i * (bus + 1)) % 12]);
+            }
+            if (route.is_roundtrip) {
+                route.stops.push_back(route.stops.front());
+            }
+            for (std::size_t i = 0; i + 1 < route.stops.size(); ++i) {
+                network.distances[{route.stops[i], route.stops[i + 1]}] = distance(generator);
+                network.distances[{route.stops[i + 1], route.stops[i]}] = distance(generator);
+            }
+            network.buses["B"s + std::to_string(bus)] = std::move(route);
+        }
+        // S12 и S13 не входят ни в один маршрут
+        return network;
+    }
+
+    Bus MakeBus(const TransportCatalogue& catalogue, std::string_view name, const Network::BusRoute& route) {
+        Bus bus{name, {}, route.is_roundtrip};
+        for (const auto& stop_name : route.stops) {
+            bus.stops.push_back(catalogue.FindStop(stop_name));
+        }
+        return bus;
+    }
+
+    std::unique_ptr<Snapshot> BuildSnapshot(const Network& network, RouteEngine engine) {
+        auto snapshot = std::make_unique<Snapshot>();
+        TransportCatalogue& catalogue = snapshot->GetCatalogue();
+        for (const auto& [name, coordinates] : network.stops) {
+            catalogue.AddStop({name, coordinates});
+        }
+        for (const auto& [stops, distance] : network.distances) {
+            catalogue.SetDistanceBetweenStops(catalogue.FindStop(stops.first), catalogue.FindStop(stops.second), distance);
+        }
+        for (const auto& [name, route] : network.buses) {
+            catalogue.AddBus(MakeBus(catalogue, name, route));
+        }
+        catalogue.Freeze();
+        snapshot->GetRouter().SetSettingsAndBuild({4, 30, engine});
+        return snapshot;
+    }
+
+    std::string GetEngineHint(RouteEngine engine) {
+        return "engine "s + std::to_string(static_cast<int>(engine));
+    }
+
+    // Обновлённая версия отвечает так же, как версия, построенная с нуля по той же сети
+    void AssertSameAsRebuilt(const Snapshot& updated, const Network& network, RouteEngine engine) {
+        const auto rebuilt = BuildSnapshot(network, engine);
+        const std::string hint = GetEngineHint(engine);
+        ASSERT_HINT(updated.GetCatalogue().IsFrozen(), hint);
+        ASSERT_EQUAL_HINT(updated.GetCatalogue().GetStops().size(), network.stops.size(), hint);
+        ASSERT_EQUAL_HINT(updated.GetCatalogue().GetBuses().size(), network.buses.size(), hint);
+        for (const auto& [name, route] : network.buses) {
+            const BusInfo expected = rebuilt->GetCatalogue().GetBusInfo(name);
+            const BusInfo actual = updated.GetCatalogue().GetBusInfo(name);
+            ASSERT_EQUAL_HINT(actual.route_length, expected.route_length, hint);
+            ASSERT_EQUAL_HINT(actual.unique_stops, expected.unique_stops, hint);
+        }
+        for (const auto& [from, from_coordinates] : network.stops) {
+            ASSERT_EQUAL_HINT(updated.GetCatalogue().GetStopInfo(from).size(),
+                              rebuilt->GetCatalogue().GetStopInfo(from).size(), hint);
+            for (const auto& [to, to_coordinates] : network.stops) {
+                const auto expected = rebuilt->GetRouter().GetRouteInfo(from, to);
+                const auto actual = updated.GetRouter().GetRouteInfo(from, to);
+                ASSERT_EQUAL_HINT(actual.has_value(), expected.has_value(), hint + " "s + from + " -> "s + to);
+                if (expected) {
+                    ASSERT_HINT(std::abs(actual->total_time - expected->total_time) < 1e-9,
+                                hint + " "s + from + " -> "s + to);
+                }
+            }
+        }
+    }
+
+    const std::vector<RouteEngine> ENGINES = {
+        RouteEngine::ALL_PAIRS, RouteEngine::DIJKSTRA, RouteEngine::CONTRACTION_HIERARCHIES,
+        RouteEngine::A_STAR, RouteEngine::BIDIRECTIONAL, RouteEngine::RAPTOR,
+    };
+
+    // Каждое изменение применяется к следующей версии и сравнивается с перестроением с нуля
+    void TestUpdatesMatchRebuild() {
+        for (const RouteEngine engine : ENGINES) {
+            std::mt19937 generator(42);
+            Network network = MakeNetwork(generator);
+            VersionedHandle<Snapshot> versions;
+            versions.Publish(BuildSnapshot(network, engine));
+
+            auto check = [&] {
+                AssertSameAsRebuilt(*versions.Acquire(), network, engine);
+            };
+
+            network.stops["New"] = {55.615, 37.615};
+            versions.Update([](Snapshot& snapshot) {
+                snapshot.AddStop({"New"sv, {55.615, 37.615}});
+            });
+            check();
+
+            network.distances[{"S1", "New"}] = 700;
+            network.distances[{"New", "S2"}] = 900;
+            network.buses["N"] = {{"S1", "New", "S2"}, false};
+            versions.Update([&network](Snapshot& snapshot) {
+                snapshot.SetDistanceBetweenStops("S1"sv, "New"sv, 700);
+                snapshot.SetDistanceBetweenStops("New"sv, "S2"sv, 900);
+                snapshot.AddBus(MakeBus(snapshot.GetCatalogue(), "N"sv, network.buses.at("N")));
+            });
+            check();
+
+            const auto& b1 = network.buses.at("B1").stops;
+            const std::pair<std::string, std::string> segment{b1[1], b1[2]};
+            network.distances[segment] = 200;
+            versions.Update([&segment](Snapshot& snapshot) {
+                snapshot.SetDistanceBetweenStops(segment.first, segment.second, 200);
+            });
+            check();
+
+            network.buses["B2"] = {{"S12", "S0", "S5", "S12"}, true};
+            network.distances[{"S12", "S0"}] = 1100;
+            network.distances[{"S0", "S5"}] = 1300;
+            network.distances[{"S5", "S12"}] = 1200;
+            versions.Update([&network](Snapshot& snapshot) {
+                snapshot.SetDistanceBetweenStops("S12"sv, "S0"sv, 1100);
+                snapshot.SetDistanceBetweenStops("S0"sv, "S5"sv, 1300);
+                snapshot.SetDistanceBetweenStops("S5"sv, "S12"sv, 1200);
+                snapshot.AddBus(MakeBus(snapshot.GetCatalogue(), "B2"sv, network.buses.at("B2")));
+            });
+            check();
+
+            network.buses.erase("B3");
+            versions.Update([](Snapshot& snapshot) {
+                snapshot.RemoveBus("B3"sv);
+            });
+            check();
+
+            network.stops.erase("S13");
+            versions.Update([](Snapshot& snapshot) {
+                snapshot.RemoveStop("S13"sv);
+            });
+            check();
+
+            versions.Reclaim();
+            ASSERT_EQUAL(versions.GetRetiredCount(), 0u);
+        }
+    }
+
+    // Быстрый путь идёт с пересадкой на X. Когда X уносится далеко по прямой при тех же дорогах,
+    // оценка A* должна ослабнуть, иначе она превысит оставшееся время и путь через X потеряется
+    void TestStopCoordinatesUpdateMatchesRebuild() {
+        Network network;
+        network.stops = {
+            {"S", {55.600, 37.600}}, {"X", {55.605, 37.605}}, {"T", {55.610, 37.610}}, {"Y", {55.605, 37.615}},
+        };
+        network.buses["1"] = {{"S", "X"}, false};
+        network.buses["2"] = {{"X", "T"}, false};
+        network.buses["3"] = {{"S", "Y", "T"}, false};
+        network.distances = {
+            {{"S", "X"}, 1000}, {{"X", "T"}, 1000}, {{"S", "Y"}, 3000}, {{"Y", "T"}, 3000},
+        };
+
+        for (const RouteEngine engine : ENGINES) {
+            Network moved = network;
+            VersionedHandle<Snapshot> versions;
+            versions.Publish(BuildSnapshot(moved, engine));
+
+            moved.stops["X"] = {56.100, 38.100};
+            versions.Update([](Snapshot& snapshot) {
+                snapshot.SetStopCoordinates("X"sv, {56.100, 38.100});
+            });
+            AssertSameAsRebuilt(*versions.Acquire(), moved, engine);
+            ASSERT(versions.Acquire()->GetCatalogue().FindStop("X"sv)->coordinates == moved.stops["X"]);
+
+            moved.stops["X"] = {55.606, 37.604};
+            versions.Update([](Snapshot& snapshot) {
+                snapshot.SetStopCoordinates("X"sv, {55.606, 37.604});
+            });
+            AssertSameAsRebuilt(*versions.Acquire(), moved, engine);
+        }
+    }
+
+    // Читатель старой версии не видит изменений, а неудачное обновление не публикуется
+    void TestUpdateKeepsPublishedVersion() {
+        std::mt19937 generator(7);
+        const Network network = MakeNetwork(generator);
+        VersionedHandle<Snapshot> versions;
+        versions.Publish(BuildSnapshot(network, RouteEngine::ALL_PAIRS));
+
+        const auto old_version = versions.Acquire();
+        const auto old_route = old_version->GetRouter().GetRouteInfo("S0"sv, "S4"sv);
+        versions.Update([](Snapshot& snapshot) {
+            snapshot.RemoveBus("B0"sv);
+        });
+        ASSERT(old_version->GetCatalogue().FindBus("B0"sv) != nullptr);
+        const auto route = old_version->GetRouter().GetRouteInfo("S0"sv, "S4"sv);
+        ASSERT_EQUAL(route.has_value(), old_route.has_value());
+        ASSERT(versions.Acquire()->GetCatalogue().FindBus("B0"sv) == nullptr);
+        ASSERT_EQUAL(versions.GetRetiredCount(), 1u);
+
+        const Snapshot* current = versions.Acquire().Get();
+        bool is_thrown = false;
+        try {
+            versions.Update([](Snapshot& snapshot) {
+                snapshot.AddStop({"Extra"sv, {55.6, 37.6}});
+                // Через остановку ходят автобусы
+                snapshot.RemoveStop("S0"sv);
+            });
+        } catch (const std::logic_error&) {
+            is_thrown = true;
+        }
+        ASSERT(is_thrown);
+        ASSERT_EQUAL(versions.Acquire().Get(), current);
+        ASSERT(versions.Acquire()->GetCatalogue().FindStop("Extra"sv) == nullptr);
+    }
+
+}  // namespace
+
+void TestSnapshot() {
+    RUN_TEST(TestAcquireWaitsForFreeSlot);
+    RUN_TEST(TestConcurrentPublishAndReclaim);
+    RUN_TEST(TestUpdatesMatchRebuild);
+    RUN_TEST(TestUpdateKeepsPublishedVersion);
+    RUN_TEST(TestStopCoordinatesUpdateMatchesRebuild);
+}
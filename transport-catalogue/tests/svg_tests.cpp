@@ -0,0 +1,51 @@
+#include "tests.h"
+#include "test_framework.h"
+#include "../svg.h"
+
+#include <sstream>
+#include <string>
+
+using namespace std::literals;
+
+namespace {
+
+    // Документ объявлен как SVG 1.1, поэтому ссылка use задаётся через xlink:href
+    void TestUseRendersXlinkHref() {
+        svg::Document doc;
+        doc.GetDefinitions().Add(svg::Circle().SetId("s"s).SetRadius(5));
+        doc.Add(svg::Use().SetHref("s"s).SetPosition({10, 20}));
+        std::ostringstream out;
+        doc.Render(out);
+        const std::string svg = out.str();
+
+        ASSERT(svg.find("<svg xmlns=\"http://www.w3.org/2000/svg\" "
+                        "xmlns:xlink=\"http://www.w3.org/1999/xlink\" version=\"1.1\">"sv) != std::string::npos);
+        ASSERT(svg.find("<use xlink:href=\"#s\" x=\"10\" y=\"20\""sv) != std::string::npos);
+        ASSERT(svg.find(" href="sv) == std::string::npos);
+    }
+
+    // Без ссылок корень остаётся прежним, и вывод без компактного режима не меняется
+    void TestXlinkOnlyWithLinks() {
+        svg::Document doc;
+        doc.Add(svg::Circle().SetRadius(5));
+        std::ostringstream out;
+        doc.Render(out);
+        ASSERT(out.str().find("<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">"sv) != std::string::npos);
+        ASSERT(out.str().find("xlink"sv) == std::string::npos);
+
+        // Ссылка внутри фрагмента, как при параллельной отрисовке
+        svg::Fragment fragment;
+        fragment.Add(svg::Use().SetHref("s"s));
+        svg::Document linked;
+        linked.Add(std::move(fragment));
+        std::ostringstream linked_out;
+        linked.Render(linked_out);
+        ASSERT(linked_out.str().find("xmlns:xlink=\"http://www.w3.org/1999/xlink\""sv) != std::string::npos);
+    }
+
+}  // namespace
+
+void TestSvg() {
+    RUN_TEST(TestUseRendersXlinkHref);
+    RUN_TEST(TestXlinkOnlyWithLinks);
+}
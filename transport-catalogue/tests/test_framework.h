@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace tests {
+
+    // При нарушении проверки выводит место и условие и аварийно завершает программу
+    template <typename T, typename U>
+    void AssertEqualImpl(const T& t, const U& u, const std::string& t_str, const std::string& u_str,
+                         const std::string& file, const std::string& func, unsigned line, const std::string& hint) {
+        if (t != u) {
+            std::cerr << file << "(" << line << "): " << func << ": ";
+            std::cerr << "ASSERT_EQUAL(" << t_str << ", " << u_str << ") failed: ";
+            std::cerr << t << " != " << u << ".";
+            if (!hint.empty()) {
+                std::cerr << " Hint: " << hint;
+            }
+            std::cerr << std::endl;
+            std::abort();
+        }
+    }
+
+    inline void AssertImpl(bool value, const std::string& expr_str, const std::string& file, const std::string& func,
+                           unsigned line, const std::string& hint) {
+        if (!value) {
+            std::cerr << file << "(" << line << "): " << func << ": ";
+            std::cerr << "ASSERT(" << expr_str << ") failed.";
+            if (!hint.empty()) {
+                std::cerr << " Hint: " << hint;
+            }
+            std::cerr << std::endl;
+            std::abort();
+        }
+    }
+
+    template <typename Func>
+    void RunTestImpl(Func func, const std::string& func_name) {
+        func();
+        std::cerr << func_name << " OK" << std::endl;
+    }
+
+}  // namespace tests
+
+#define ASSERT_EQUAL(a, b) tests::AssertEqualImpl((a), (b), #a, #b, __FILE__, __FUNCTION__, __LINE__, "")
+#define ASSERT_EQUAL_HINT(a, b, hint) tests::AssertEqualImpl((a), (b), #a, #b, __FILE__, __FUNCTION__, __LINE__, (hint))
+#define ASSERT(expr) tests::AssertImpl(!!(expr), #expr, __FILE__, __FUNCTION__, __LINE__, "")
+#define ASSERT_HINT(expr, hint) tests::AssertImpl(!!(expr), #expr, __FILE__, __FUNCTION__, __LINE__, (hint))
+#define RUN_TEST(func) tests::RunTestImpl((func), #func)
@@ -0,0 +1,10 @@
+#pragma once
+
+// Группы тестов, каждая определена в своём файле
+void TestTransportCatalogue();
+void TestTransportRouter();
+void TestSvg();
+void TestMapRenderer();
+void TestShortestPathTree();
+void TestSnapshot();
+void TestJson();
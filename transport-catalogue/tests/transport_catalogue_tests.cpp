@@ -0,0 +1,236 @@
+#include "tests.h"
+#include "test_framework.h"
+#include "../json_reader.h"
+#include "../request_handler.h"
+#include "../snapshot.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+using namespace transport_catalogue;
+
+namespace {
+
+    void TestDuplicateNamesFreeze() {
+        TransportCatalogue catalogue;
+        catalogue.AddStop({"A"sv, {55.0, 37.0}});
+        catalogue.AddStop({"B"sv, {55.1, 37.1}});
+        catalogue.AddStop({"A"sv, {56.0, 38.0}});
+        const Stop* a = catalogue.FindStop("A"sv);
+        const Stop* b = catalogue.FindStop("B"sv);
+        catalogue.SetDistanceBetweenStops(a, b, 1000);
+        catalogue.AddBus({"1"sv, std::pmr::vector<const Stop*>{a, b}, true});
+        catalogue.AddBus({"1"sv, std::pmr::vector<const Stop*>{b, a, b}, false});
+
+        catalogue.Freeze();
+        ASSERT(catalogue.IsFrozen());
+        // Повтор имени не заменяет первую запись
+        ASSERT_EQUAL(catalogue.FindStop("A"sv), a);
+        ASSERT_EQUAL(catalogue.FindStop("A"sv)->coordinates.lat, 55.0);
+        ASSERT_EQUAL(catalogue.FindBus("1"sv)->stops.size(), 2u);
+        ASSERT_EQUAL(catalogue.SearchStops("A"sv, 10).size(), 1u);
+
+        catalogue.Freeze(catalogue.GetFrozenNames());
+        ASSERT_EQUAL(catalogue.FindStop("A"sv), a);
+    }
+
+    void TestDuplicateStopInput() {
+        std::istringstream input(R"({
+            "base_requests": [
+                {"type": "Stop", "name": "A", "latitude": 55.0, "longitude": 37.0,
+                 "road_distances": {"B": 1000}},
+                {"type": "Stop", "name": "B", "latitude": 55.01, "longitude": 37.0, "road_distances": {}},
+                {"type": "Stop", "name": "A", "latitude": 56.0, "longitude": 38.0, "road_distances": {}},
+                {"type": "Bus", "name": "1", "stops": ["A", "B"], "is_roundtrip": false}
+            ],
+            "render_settings": {},
+            "routing_settings": {"bus_wait_time": 2, "bus_velocity": 30},
+            "stat_requests": [
+                {"id": 1, "type": "Stop", "name": "A"},
+                {"id": 2, "type": "Route", "from": "A", "to": "B"}
+            ]
+        })");
+        json_reader::JsonReader reader(input);
+        Snapshot snapshot;
+        reader.ApplyCommands(snapshot.GetCatalogue());
+        snapshot.GetCatalogue().Freeze();
+        reader.ApplyRouteSettingsCommands(snapshot.GetRouter());
+        RequestHandler handler(snapshot);
+
+        const auto buses = handler.GetBusesByStop("A"sv);
+        ASSERT(buses.has_value());
+        ASSERT_EQUAL(buses->size(), 1u);
+        const auto route = handler.GetRouteInfo("A"sv, "B"sv);
+        ASSERT(route.has_value());
+        ASSERT_EQUAL(route->items.size(), 2u);
+    }
+
+    // Маршрут длиннее блока, которым считаются расстояния по прямой
+    void TestCurvatureOfLongBus() {
+        TransportCatalogue catalogue;
+        std::vector<std::string> names;
+        for (int i = 0; i < 150; ++i) {
+            names.push_back("S"s + std::to_string(i));
+        }
+        std::pmr::vector<const Stop*> stops;
+        double geo_length = 0.0;
+        for (int i = 0; i < 150; ++i) {
+            const Coordinates coordinates{55.0 + 0.001 * i, 37.0 + 0.002 * (i % 7)};
+            catalogue.AddStop({names[i], coordinates});
+            stops.push_back(catalogue.FindStop(names[i]));
+            if (i > 0) {
+                catalogue.SetDistanceBetweenStops(stops[i - 1], stops[i], 500);
+                geo_length += geo::ComputeDistance(stops[i - 1]->coordinates, coordinates);
+            }
+        }
+        catalogue.AddBus({"long"sv, stops, true});
+
+        const BusInfo info = catalogue.GetBusInfo("long"sv);
+        ASSERT_EQUAL(info.route_length, 149 * 500);
+        ASSERT(std::abs(info.curvature - info.route_length / geo_length) < 1e-6);
+    }
+
+    // Обработка входа, как в main, с потоковой загрузкой или без неё
+    std::string Process(const std::string& text, bool is_pipelined) {
+        std::istringstream input(text);
+        Snapshot snapshot;
+        json_reader::JsonReader reader = is_pipelined
+            ? json_reader::JsonReader(input, snapshot.GetCatalogue(), snapshot.GetRouter())
+            : json_reader::JsonReader(input);
+        reader.ApplyCommands(snapshot.GetCatalogue());
+        snapshot.GetCatalogue().Freeze();
+        reader.ApplyRenderSettingsCommands(snapshot.GetRenderer());
+        reader.ApplyRouteSettingsCommands(snapshot.GetRouter());
+        RequestHandler handler(snapshot);
+        std::ostringstream out;
+        reader.PrintJson(handler, out);
+        return out.str();
+    }
+
+    std::string MakeDocument(const std::vector<std::string>& commands, const std::vector<std::string>& stop_names) {
+        std::string text = R"({"base_requests": [)";
+        for (std::size_t i = 0; i < commands.size(); ++i) {
+            text += (i > 0 ? ","s : ""s) + commands[i];
+        }
+        text += R"(], "render_settings": {"width": 600, "height": 400, "padding": 50, "line_width": 14,
+            "stop_radius": 5, "bus_label_font_size": 20, "bus_label_offset": [7, 15],
+            "stop_label_font_size": 18, "stop_label_offset": [7, -3], "underlayer_color": "white",
+            "underlayer_width": 3, "color_palette": ["green", "red"]},
+            "routing_settings": {"bus_wait_time": 2, "bus_velocity": 30}, "stat_requests": [)";
+        int id = 0;
+        text += R"({"id": 0, "type": "Map"})";
+        for (const auto& from : stop_names) {
+            text += R"(, {"id": )" + std::to_string(++id) + R"(, "type": "Stop", "name": ")" + from + R"("})";
+            for (const auto& to : stop_names) {
+                text += R"(, {"id": )" + std::to_string(++id) + R"(, "type": "Route", "from": ")"
+                    + from + R"(", "to": ")" + to + R"("})";
+            }
+        }
+        return text + "]}";
+    }
+
+    std::string MakeStopCommand(const std::string& name, double lat, double lng,
+                                const std::map<std::string, int>& distances) {
+        std::string command = R"({"type": "Stop", "name": ")" + name + R"(", "latitude": )" + std::to_string(lat)
+            + R"(, "longitude": )" + std::to_string(lng) + R"(, "road_distances": {)";
+        for (const auto& [to, distance] : distances) {
+            command += (command.back() == '{' ? "\""s : ", \""s) + to + "\": "s + std::to_string(distance);
+        }
+        return command + "}}";
+    }
+
+    std::string MakeBusCommand(const std::string& name, const std::vector<std::string>& stops, bool is_roundtrip) {
+        std::string command = R"({"type": "Bus", "name": ")" + name + R"(", "stops": [)";
+        for (std::size_t i = 0; i < stops.size(); ++i) {
+            command += (i > 0 ? ", \""s : "\""s) + stops[i] + "\"";
+        }
+        return command + "], \"is_roundtrip\": "s + (is_roundtrip ? "true"s : "false"s) + "}";
+    }
+
+    // Повторная команда Stop после автобуса меняет расстояние, уже учтённое в рёбрах PrepareBus
+    void TestPipelinedRepeatedStop() {
+        const std::string text = MakeDocument({
+            MakeStopCommand("A"s, 55.0, 37.0, {{"B"s, 1000}}),
+            MakeStopCommand("B"s, 55.01, 37.0, {}),
+            MakeBusCommand("1"s, {"A"s, "B"s}, false),
+            MakeStopCommand("A"s, 55.0, 37.0, {{"B"s, 5000}})
+        }, {"A"s, "B"s});
+        const std::string sequential = Process(text, false);
+        ASSERT_EQUAL(Process(text, true), sequential);
+        ASSERT(sequential.find("\"total_time\": 12") != std::string::npos);
+    }
+
+    // Остановки, расстояния и автобусы в случайном порядке, часть остановок повторяется
+    void TestPipelinedMatchesSequential() {
+        std::mt19937 generator(48);
+        for (int iteration = 0; iteration < 20; ++iteration) {
+            const int stop_count = std::uniform_int_distribution<int>(2, 8)(generator);
+            std::vector<std::string> names;
+            for (int i = 0; i < stop_count; ++i) {
+                names.push_back("S"s + std::to_string(i));
+            }
+            auto random_stop = [&]() {
+                return names[std::uniform_int_distribution<int>(0, stop_count - 1)(generator)];
+            };
+            auto random_distances = [&]() {
+                std::map<std::string, int> distances;
+                for (int i = std::uniform_int_distribution<int>(0, 3)(generator); i > 0; --i) {
+                    distances[random_stop()] = std::uniform_int_distribution<int>(500, 5000)(generator);
+                }
+                return distances;
+            };
+            auto random_coordinate = [&]() {
+                return std::uniform_real_distribution<double>(0.0, 0.05)(generator);
+            };
+
+            std::map<std::string, std::map<std::string, int>> distances;
+            for (const auto& name : names) {
+                distances[name] = random_distances();
+            }
+            std::vector<std::string> commands;
+            for (int bus = std::uniform_int_distribution<int>(1, 4)(generator); bus > 0; --bus) {
+                std::vector<std::string> stops;
+                for (int i = std::uniform_int_distribution<int>(2, 5)(generator); i > 0; --i) {
+                    stops.push_back(random_stop());
+                }
+                const bool is_roundtrip = generator() % 2 == 0;
+                if (is_roundtrip) {
+                    stops.push_back(stops.front());
+                }
+                // Расстояние между соседними остановками во входе задано хотя бы в одну сторону
+                for (std::size_t i = 0; i + 1 < stops.size(); ++i) {
+                    if (distances[stops[i]].count(stops[i + 1]) == 0 && distances[stops[i + 1]].count(stops[i]) == 0) {
+                        distances[stops[i]][stops[i + 1]] = std::uniform_int_distribution<int>(500, 5000)(generator);
+                    }
+                }
+                commands.push_back(MakeBusCommand(std::to_string(bus), stops, is_roundtrip));
+            }
+            for (const auto& name : names) {
+                commands.push_back(MakeStopCommand(name, 55.0 + random_coordinate(), 37.0 + random_coordinate(),
+                                                   distances[name]));
+            }
+            std::shuffle(commands.begin(), commands.end(), generator);
+            for (int i = std::uniform_int_distribution<int>(0, 3)(generator); i > 0; --i) {
+                commands.push_back(MakeStopCommand(random_stop(), 56.0, 38.0, random_distances()));
+            }
+
+            const std::string text = MakeDocument(commands, names);
+            ASSERT_EQUAL_HINT(Process(text, true), Process(text, false), text);
+        }
+    }
+
+}  // namespace
+
+void TestTransportCatalogue() {
+    RUN_TEST(TestDuplicateNamesFreeze);
+    RUN_TEST(TestDuplicateStopInput);
+    RUN_TEST(TestCurvatureOfLongBus);
+    RUN_TEST(TestPipelinedRepeatedStop);
+    RUN_TEST(TestPipelinedMatchesSequential);
+}
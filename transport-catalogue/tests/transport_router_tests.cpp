@@ -0,0 +1,278 @@
+#include "tests.h"
+#include "test_framework.h"
+#include "../transport_router.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using namespace std::literals;
+using namespace transport_catalogue;
+using namespace transport_router;
+
+namespace {
+
+    const std::vector<RouteEngine> ENGINES = {
+        RouteEngine::ALL_PAIRS, RouteEngine::DIJKSTRA, RouteEngine::CONTRACTION_HIERARCHIES,
+        RouteEngine::A_STAR, RouteEngine::BIDIRECTIONAL, RouteEngine::RAPTOR,
+    };
+
+    // Два маршрута с пересадкой на остановке B
+    void FillSmallCatalogue(TransportCatalogue& catalogue) {
+        catalogue.AddStop({"A"sv, {55.60, 37.60}});
+        catalogue.AddStop({"B"sv, {55.61, 37.61}});
+        catalogue.AddStop({"C"sv, {55.62, 37.62}});
+        const Stop* a = catalogue.FindStop("A"sv);
+        const Stop* b = catalogue.FindStop("B"sv);
+        const Stop* c = catalogue.FindStop("C"sv);
+        catalogue.SetDistanceBetweenStops(a, b, 1500);
+        catalogue.SetDistanceBetweenStops(b, c, 2000);
+        catalogue.AddBus({"1"sv, std::pmr::vector<const Stop*>{a, b}, false});
+        catalogue.AddBus({"2"sv, std::pmr::vector<const Stop*>{b, c}, false});
+    }
+
+    // Случайная сеть: у маршрута от двух до max_bus_stops остановок. Как и в JsonReader,
+    // кольцевой маршрут замкнут, а некольцевой проходится туда и обратно.
+    // Обратное расстояние задано не для всех перегонов
+    void FillRandomCatalogue(TransportCatalogue& catalogue, std::mt19937& generator,
+                             int stop_count, int bus_count, int max_bus_stops) {
+        std::uniform_real_distribution<double> offset(0.0, 0.05);
+        std::uniform_int_distribution<int> stop_index(0, stop_count - 1);
+        std::uniform_int_distribution<int> bus_stops(2, max_bus_stops);
+        std::uniform_int_distribution<int> distance(500, 4000);
+        std::bernoulli_distribution coin(0.5);
+        std::vector<const Stop*> stops;
+        for (int i = 0; i < stop_count; ++i) {
+            catalogue.AddStop({"S"s + std::to_string(i), {55.6 + offset(generator), 37.6 + offset(generator)}});
+            stops.push_back(catalogue.FindStop("S"s + std::to_string(i)));
+        }
+        for (int bus = 0; bus < bus_count; ++bus) {
+            std::vector<int> order(stop_count);
+            for (int i = 0; i < stop_count; ++i) {
+                order[i] = i;
+            }
+            std::shuffle(order.begin(), order.end(), generator);
+            const bool is_roundtrip = coin(generator);
+            std::pmr::vector<const Stop*> route;
+            for (int i = 0, count = std::min(bus_stops(generator), stop_count); i < count; ++i) {
+                route.push_back(stops[order[i]]);
+            }
+            for (std::size_t i = 0; i + 1 < route.size(); ++i) {
+                catalogue.SetDistanceBetweenStops(route[i], route[i + 1], distance(generator));
+                if (coin(generator)) {
+                    catalogue.SetDistanceBetweenStops(route[i + 1], route[i], distance(generator));
+                }
+            }
+            if (is_roundtrip) {
+                catalogue.SetDistanceBetweenStops(route.back(), route.front(), distance(generator));
+                route.push_back(route.front());
+            } else {
+                route.insert(route.end(), route.rbegin() + 1, route.rend());
+            }
+            catalogue.AddBus({"B"s + std::to_string(bus), std::move(route), is_roundtrip});
+        }
+        catalogue.Freeze();
+    }
+
+    // Поездка без пересадок: ожидание на остановке и проезд до to
+    struct Leg {
+        const Stop* to;
+        double time;
+    };
+
+    using Legs = std::unordered_map<const Stop*, std::vector<Leg>>;
+
+    // Поездки строятся прямо по последовательностям остановок автобусов, без графа маршрутизатора
+    Legs GetLegs(const TransportCatalogue& catalogue, const RouteSettings& settings) {
+        Legs legs;
+        for (const Bus& bus : catalogue.GetBuses()) {
+            for (std::size_t i = 0; i + 1 < bus.stops.size(); ++i) {
+                double distance = 0.0;
+                for (std::size_t j = i; j + 1 < bus.stops.size(); ++j) {
+                    distance += catalogue.GetDistanceBetweenStops(bus.stops[j], bus.stops[j + 1]);
+                    const double ride_time = distance * 60 / (settings.bus_velocity * 1000);
+                    legs[bus.stops[i]].push_back({bus.stops[j + 1], settings.bus_wait_time + ride_time});
+                }
+            }
+        }
+        return legs;
+    }
+
+    // Обычный алгоритм Дейкстры по поездкам: время пути от from до каждой достижимой остановки
+    std::unordered_map<const Stop*, double> GetReferenceTimes(const Legs& legs, const Stop* from) {
+        using Entry = std::pair<double, const Stop*>;
+        std::unordered_map<const Stop*, double> times{{from, 0.0}};
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+        queue.push({0.0, from});
+        while (!queue.empty()) {
+            const auto [time, stop] = queue.top();
+            queue.pop();
+            if (time > times.at(stop)) {
+                continue;
+            }
+            const auto stop_legs = legs.find(stop);
+            if (stop_legs == legs.end()) {
+                continue;
+            }
+            for (const Leg& leg : stop_legs->second) {
+                const auto known = times.find(leg.to);
+                if (known == times.end() || time + leg.time < known->second) {
+                    times[leg.to] = time + leg.time;
+                    queue.push({time + leg.time, leg.to});
+                }
+            }
+        }
+        return times;
+    }
+
+    // Времена всех маршрутов от from до to, не проходящих остановку дважды, по возрастанию
+    std::vector<double> GetAllRouteTimes(const Legs& legs, const Stop* from, const Stop* to) {
+        std::vector<double> times;
+        std::unordered_set<const Stop*> visited = {from};
+        std::function<void(const Stop*, double)> visit = [&](const Stop* stop, double time) {
+            if (stop == to) {
+                times.push_back(time);
+                return;
+            }
+            const auto stop_legs = legs.find(stop);
+            if (stop_legs == legs.end()) {
+                return;
+            }
+            for (const Leg& leg : stop_legs->second) {
+                if (visited.insert(leg.to).second) {
+                    visit(leg.to, time + leg.time);
+                    visited.erase(leg.to);
+                }
+            }
+        };
+        visit(from, 0.0);
+        std::sort(times.begin(), times.end());
+        return times;
+    }
+
+    bool IsClose(double lhs, double rhs) {
+        return std::abs(lhs - rhs) < 1e-9 * std::max(1.0, std::abs(rhs));
+    }
+
+    // Время элементов маршрута складывается в общее, каждая поездка начинается с ожидания
+    void AssertConsistentItems(const RouteItems& route, const std::string& hint) {
+        double total_time = 0.0;
+        for (std::size_t i = 0; i < route.items.size(); ++i) {
+            total_time += route.items[i].time;
+            ASSERT_EQUAL_HINT(route.items[i].type, i % 2 == 0 ? "Wait"sv : "Bus"sv, hint);
+        }
+        ASSERT_HINT(route.items.size() % 2 == 0, hint);
+        ASSERT_HINT(IsClose(total_time, route.total_time), hint);
+    }
+
+    std::string GetEngineHint(RouteEngine engine) {
+        return "engine "s + std::to_string(static_cast<int>(engine));
+    }
+
+    void TestEnginesMatchDijkstra() {
+        std::mt19937 generator(34);
+        for (int network = 0; network < 3; ++network) {
+            TransportCatalogue catalogue;
+            FillRandomCatalogue(catalogue, generator, 30, 10, 8);
+            const RouteSettings base_settings{6, 40};
+            const Legs legs = GetLegs(catalogue, base_settings);
+            std::vector<std::string_view> names;
+            for (const Stop& stop : catalogue.GetStops()) {
+                names.push_back(stop.name);
+            }
+
+            for (const RouteEngine engine : ENGINES) {
+                TransportRouter router(catalogue);
+                router.SetSettingsAndBuild({base_settings.bus_wait_time, base_settings.bus_velocity, engine});
+                const RouteMatrix matrix = router.GetRouteMatrix(names, names);
+                for (std::size_t i = 0; i < names.size(); ++i) {
+                    const auto expected = GetReferenceTimes(legs, catalogue.FindStop(names[i]));
+                    for (std::size_t j = 0; j < names.size(); ++j) {
+                        const auto hint = GetEngineHint(engine) + " "s + std::string(names[i]) + " -> "s
+                            + std::string(names[j]);
+                        const auto expected_time = expected.find(catalogue.FindStop(names[j]));
+                        const auto route = router.GetRouteInfo(names[i], names[j]);
+                        ASSERT_EQUAL_HINT(route.has_value(), expected_time != expected.end(), hint);
+                        ASSERT_EQUAL_HINT(matrix[i][j].has_value(), expected_time != expected.end(), hint);
+                        if (route) {
+                            ASSERT_HINT(IsClose(route->total_time, expected_time->second), hint);
+                            ASSERT_HINT(IsClose(*matrix[i][j], expected_time->second), hint);
+                            AssertConsistentItems(*route, hint);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void TestAlternativesMatchBruteForce() {
+        constexpr std::size_t COUNT = 5;
+        std::mt19937 generator(38);
+        for (int network = 0; network < 20; ++network) {
+            TransportCatalogue catalogue;
+            FillRandomCatalogue(catalogue, generator, 8, 5, 4);
+            const RouteSettings base_settings{6, 40};
+            const Legs legs = GetLegs(catalogue, base_settings);
+
+            for (const RouteEngine engine : ENGINES) {
+                // Без графа RAPTOR возвращает только лучший маршрут
+                if (engine == RouteEngine::RAPTOR) {
+                    continue;
+                }
+                TransportRouter router(catalogue);
+                router.SetSettingsAndBuild({base_settings.bus_wait_time, base_settings.bus_velocity, engine});
+                for (const Stop& from : catalogue.GetStops()) {
+                    for (const Stop& to : catalogue.GetStops()) {
+                        if (&from == &to) {
+                            continue;
+                        }
+                        const auto hint = GetEngineHint(engine) + " "s + std::string(from.name) + " -> "s
+                            + std::string(to.name);
+                        const auto expected = GetAllRouteTimes(legs, &from, &to);
+                        const auto alternatives = router.GetRouteAlternatives(from.name, to.name, COUNT);
+                        ASSERT_EQUAL_HINT(alternatives.size(), std::min(COUNT, expected.size()), hint);
+                        for (std::size_t i = 0; i < alternatives.size(); ++i) {
+                            ASSERT_HINT(IsClose(alternatives[i].total_time, expected[i]), hint);
+                            AssertConsistentItems(alternatives[i], hint);
+                            std::unordered_set<std::string_view> wait_stops = {to.name};
+                            for (const Item& item : alternatives[i].items) {
+                                if (item.type == "Wait"sv) {
+                                    ASSERT_HINT(wait_stops.insert(item.name).second, hint);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void TestUnknownStops() {
+        TransportCatalogue catalogue;
+        FillSmallCatalogue(catalogue);
+        for (const RouteEngine engine : ENGINES) {
+            TransportRouter router(catalogue);
+            router.SetSettingsAndBuild({6, 40, engine});
+            const auto hint = "engine "s + std::to_string(static_cast<int>(engine));
+            ASSERT_HINT(router.GetRouteInfo("A"sv, "C"sv).has_value(), hint);
+            ASSERT_HINT(!router.GetRouteInfo("A"sv, "X"sv).has_value(), hint);
+            ASSERT_HINT(!router.GetRouteInfo("X"sv, "C"sv).has_value(), hint);
+            ASSERT_HINT(router.GetRouteAlternatives("X"sv, "C"sv, 3).empty(), hint);
+            ASSERT_HINT(router.GetRouteAlternatives("A"sv, "X"sv, 3).empty(), hint);
+        }
+    }
+
+}  // namespace
+
+void TestTransportRouter() {
+    RUN_TEST(TestUnknownStops);
+    RUN_TEST(TestEnginesMatchDijkstra);
+    RUN_TEST(TestAlternativesMatchBruteForce);
+}
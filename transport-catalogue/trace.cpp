@@ -0,0 +1,101 @@
+#include "trace.h"
+
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace trace {
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Event {
+        const char* name;
+        const char* category;
+        Clock::time_point start;
+        Clock::time_point end;
+    };
+
+    // Буфер пишет только его поток, поэтому синхронизация нужна лишь при регистрации
+    struct ThreadBuffer {
+        std::size_t thread_id;
+        std::vector<Event> events;
+    };
+
+    struct Registry {
+        std::atomic<bool> enabled = false;
+        Clock::time_point origin = Clock::now();
+        std::mutex mutex;
+        // Буферы живут до конца программы, даже если их потоки уже завершились
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    };
+
+    Registry& GetRegistry() {
+        static Registry registry;
+        return registry;
+    }
+
+    ThreadBuffer& GetThreadBuffer() {
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (buffer == nullptr) {
+            Registry& registry = GetRegistry();
+            std::lock_guard guard(registry.mutex);
+            registry.buffers.push_back(std::make_unique<ThreadBuffer>());
+            buffer = registry.buffers.back().get();
+            buffer->thread_id = registry.buffers.size();
+        }
+        return *buffer;
+    }
+
+    double ToMicroseconds(Clock::duration duration) {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    }
+
+}  // namespace
+
+    void Enable() {
+        GetRegistry().enabled.store(true, std::memory_order_relaxed);
+    }
+
+    bool IsEnabled() {
+        return GetRegistry().enabled.load(std::memory_order_relaxed);
+    }
+
+    void Span::Record(const char* name, const char* category, Clock::time_point start, Clock::time_point end) {
+        GetThreadBuffer().events.push_back({name, category, start, end});
+    }
+
+    void WriteJson(std::ostream& out) {
+        Registry& registry = GetRegistry();
+        std::lock_guard guard(registry.mutex);
+        const auto flags = out.flags();
+        const auto precision = out.precision();
+        out << std::fixed << std::setprecision(3);
+        out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+        bool is_first = true;
+        for (const auto& buffer : registry.buffers) {
+            for (const Event& event : buffer->events) {
+                out << (is_first ? "\n" : ",\n")
+                    << "{\"name\": \"" << event.name << "\", \"cat\": \"" << event.category
+                    << "\", \"ph\": \"X\", \"ts\": " << ToMicroseconds(event.start - registry.origin)
+                    << ", \"dur\": " << ToMicroseconds(event.end - event.start)
+                    << ", \"pid\": 1, \"tid\": " << buffer->thread_id << '}';
+                is_first = false;
+            }
+        }
+        out << "\n]}\n";
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+    bool WriteFile(const std::string& path) {
+        std::ofstream out(path);
+        WriteJson(out);
+        return static_cast<bool>(out);
+    }
+
+}  // namespace trace
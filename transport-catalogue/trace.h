@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace trace {
+
+    // Включает запись интервалов. Интервалы, начатые до включения, не записываются
+    void Enable();
+    bool IsEnabled();
+
+    // Записывает все интервалы в формате Trace Event (chrome://tracing, Perfetto).
+    // Вызывается, когда остальные потоки уже не пишут интервалы
+    void WriteJson(std::ostream& out);
+    // То же в файл; возвращает false, если файл не удалось записать
+    bool WriteFile(const std::string& path);
+
+    // Интервал от создания до уничтожения объекта. Каждый поток пишет в собственный буфер
+    // без блокировок. name и category должны быть строковыми литералами без кавычек
+    // и обратных косых черт: сохраняются только указатели на них
+    class Span {
+    public:
+        explicit Span(const char* name, const char* category = "app") :
+            name_(IsEnabled() ? name : nullptr), category_(category)
+        {
+            if (name_ != nullptr) {
+                start_ = Clock::now();
+            }
+        }
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+        ~Span() {
+            if (name_ != nullptr) {
+                Record(name_, category_, start_, Clock::now());
+            }
+        }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        const char* name_;
+        const char* category_;
+        Clock::time_point start_;
+
+        static void Record(const char* name, const char* category, Clock::time_point start, Clock::time_point end);
+    };
+
+}  // namespace trace
@@ -1,19 +1,68 @@
 #include "transport_catalogue.h"
+#include "trace.h"
 
+#include <algorithm>
+#include <array>
 #include <utility>
 #include <cassert>
+#include <numeric>
+#include <stdexcept>
 
 namespace transport_catalogue {
 
     using namespace std::literals;
     using namespace domain;
 
+    TransportCatalogue::TransportCatalogue(std::pmr::memory_resource* resource) :
+        names_(resource),
+        stops_(resource),
+        stopname_to_stop_(resource),
+        distance_between_stops_(resource),
+        buses_(resource),
+        busname_to_bus_(resource),
+        stopname_to_busname_(resource),
+        frozen_stops_(resource),
+        frozen_buses_(resource),
+        stop_search_(resource)
+    {}
+
+    TransportCatalogue::TransportCatalogue(const TransportCatalogue& other, std::pmr::memory_resource* resource) :
+        TransportCatalogue(resource)
+    {
+        std::unordered_map<const Stop*, const Stop*> copies;
+        copies.reserve(other.stops_.size());
+        for (const Stop& stop : other.stops_) {
+            AddStop(stop);
+            copies[&stop] = &stops_.back();
+        }
+        for (const auto& [stops, distance] : other.distance_between_stops_) {
+            SetDistanceBetweenStops(copies.at(stops.first), copies.at(stops.second), distance);
+        }
+        for (const Bus& bus : other.buses_) {
+            Bus copy{bus.name, std::pmr::vector<const Stop*>(bus.stops.size()), bus.is_roundtrip};
+            std::transform(bus.stops.begin(), bus.stops.end(), copy.stops.begin(), [&copies](const Stop* stop) {
+                return copies.at(stop);
+            });
+            AddBus(copy);
+        }
+        if (other.is_frozen_) {
+            Freeze(other.GetFrozenNames());
+        }
+    }
+
     void TransportCatalogue::AddStop(const Stop& stop) {
+        Unfreeze();
         stops_.push_back(stop);
+        stops_.back().name = names_.Intern(stop.name);
+        stops_.back().sphere_point = geo::ToSpherePoint(stop.coordinates);
         stopname_to_stop_.insert({stops_.back().name, &stops_.back()});
     }
 
     const Stop* TransportCatalogue::FindStop(const std::string_view stop_name) const {
+        if (is_frozen_) {
+            const FrozenStop* stop = frozen_stops_.Find(stop_name);
+            return stop != nullptr ? stop->stop : nullptr;
+        }
         auto stop = stopname_to_stop_.find(stop_name);
         if (stop == stopname_to_stop_.end()) {
             return nullptr;
@@ -21,6 +70,67 @@ namespace transport_catalogue {
         return stop->second;
     }
 
+    void TransportCatalogue::SetStopCoordinates(const std::string_view stop_name, Coordinates coordinates) {
+        Stop* stop = const_cast<Stop*>(stopname_to_stop_.at(stop_name));
+        stop->coordinates = coordinates;
+        stop->sphere_point = geo::ToSpherePoint(coordinates);
+    }
+
+    void TransportCatalogue::RemoveStop(const std::string_view stop_name) {
+        const Stop* removed = stopname_to_stop_.at(stop_name);
+        Unfreeze();
+        if (!GetStopInfo(stop_name).empty()) {
+            throw std::logic_error("Stop "s + std::string(removed->name) + " is used by buses"s);
+        }
+
+        for (auto it = distance_between_stops_.begin(); it != distance_between_stops_.end();) {
+            if (it->first.first == removed || it->first.second == removed) {
+                it = distance_between_stops_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        stopname_to_busname_.erase(stop_name);
+        stopname_to_stop_.erase(stop_name);
+
+        // Последняя остановка переносится на место удалённой. Индексы хранят
+        // string_view имён, поэтому записи о ней удаляются до переноса
+        Stop* slot = const_cast<Stop*>(removed);
+        Stop* last = &stops_.back();
+        if (slot == last) {
+            stops_.pop_back();
+            return;
+        }
+        stopname_to_stop_.erase(last->name);
+        auto buses = stopname_to_busname_.extract(last->name);
+
+        *slot = std::move(*last);
+        stops_.pop_back();
+
+        stopname_to_stop_.insert({slot->name, slot});
+        if (!buses.empty()) {
+            buses.key() = slot->name;
+            for (const auto& bus_name : buses.mapped()) {
+                Bus* bus = const_cast<Bus*>(busname_to_bus_.at(bus_name));
+                std::replace(bus->stops.begin(), bus->stops.end(), static_cast<const Stop*>(last),
+                             static_cast<const Stop*>(slot));
+            }
+            stopname_to_busname_.insert(std::move(buses));
+        }
+
+        std::vector<std::pair<std::pair<const Stop*, const Stop*>, int>> relinked;
+        for (auto it = distance_between_stops_.begin(); it != distance_between_stops_.end();) {
+            const auto [from, to] = it->first;
+            if (from == last || to == last) {
+                relinked.push_back({{from == last ? slot : from, to == last ? slot : to}, it->second});
+                it = distance_between_stops_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        distance_between_stops_.insert(relinked.begin(), relinked.end());
+    }
+
     void TransportCatalogue::SetDistanceBetweenStops(const Stop* stop1, const Stop* stop2, int distance) {
         distance_between_stops_[{stop1, stop2}] = distance;
     }
@@ -35,7 +145,13 @@ namespace transport_catalogue {
     }
 
     void TransportCatalogue::AddBus(const Bus& bus) {
-        buses_.push_back(bus);
+        Unfreeze();
+        // Копия вектора остановок создаётся в ресурсе справочника, а перемещение в дек его сохраняет
+        buses_.push_back({
+            names_.Intern(bus.name),
+            std::pmr::vector<const Stop*>(bus.stops.begin(), bus.stops.end(), buses_.get_allocator().resource()),
+            bus.is_roundtrip
+        });
         busname_to_bus_.insert({buses_.back().name, &buses_.back()});
         for (const auto& stop : buses_.back().stops) {
             stopname_to_busname_[stop->name].insert(buses_.back().name);
@@ -43,6 +159,10 @@ namespace transport_catalogue {
     }
 
     const Bus* TransportCatalogue::FindBus(const std::string_view bus_name) const {
+        if (is_frozen_) {
+            const Bus* const* bus = frozen_buses_.Find(bus_name);
+            return bus != nullptr ? *bus : nullptr;
+        }
         auto bus = busname_to_bus_.find(bus_name);
         if (bus == busname_to_bus_.end()) {
             return nullptr;
@@ -50,21 +170,46 @@ namespace transport_catalogue {
         return bus->second;
     }
 
-    std::size_t TransportCatalogue::GetStopsOnRoute(const std::string_view request) const {
-        auto bus = busname_to_bus_.find(request);
-        if (bus == busname_to_bus_.end()) {
-            assert("No stops on route");
+    void TransportCatalogue::RemoveBus(const std::string_view bus_name) {
+        const Bus* removed = busname_to_bus_.at(bus_name);
+        Unfreeze();
+        for (const auto& stop : removed->stops) {
+            stopname_to_busname_.at(stop->name).erase(removed->name);
+        }
+        busname_to_bus_.erase(bus_name);
+
+        // Последний автобус переносится на место удалённого
+        Bus* slot = const_cast<Bus*>(removed);
+        Bus* last = &buses_.back();
+        if (slot == last) {
+            buses_.pop_back();
+            return;
+        }
+        busname_to_bus_.erase(last->name);
+        for (const auto& stop : last->stops) {
+            stopname_to_busname_.at(stop->name).erase(last->name);
+        }
+
+        *slot = std::move(*last);
+        buses_.pop_back();
+
+        busname_to_bus_.insert({slot->name, slot});
+        for (const auto& stop : slot->stops) {
+            stopname_to_busname_.at(stop->name).insert(slot->name);
         }
-        return bus->second->stops.size();
+    }
+
+    std::size_t TransportCatalogue::GetStopsOnRoute(const std::string_view request) const {
+        const Bus* bus = FindBus(request);
+        assert(bus != nullptr && "No stops on route");
+        return bus->stops.size();
     }
 
     std::size_t TransportCatalogue::GetUniqueStops(const std::string_view request) const {
         std::unordered_set<const Stop*> unique_stops;
-        auto bus = busname_to_bus_.find(request);
-        if (bus == busname_to_bus_.end()) {
-            assert("No unique stops");
-        }
-        for (const auto& stop : bus->second->stops) {
+        const Bus* bus = FindBus(request);
+        assert(bus != nullptr && "No unique stops");
+        for (const auto& stop : bus->stops) {
             unique_stops.insert(stop);
         }
         return unique_stops.size();
@@ -72,7 +217,7 @@ namespace transport_catalogue {
 
     int TransportCatalogue::GetRouteLength(const std::string_view request) const {
         int res = 0;
-        auto& bus = busname_to_bus_.at(request);
+        const Bus* bus = FindBus(request);
         for (std::size_t i = 1; i < bus->stops.size(); ++i) {
             res += GetDistanceBetweenStops(bus->stops[i-1], bus->stops[i]);
         }
@@ -80,33 +225,160 @@ namespace transport_catalogue {
     }
 
     double TransportCatalogue::GetCurvature(const std::string_view request) const {
-        double res = 0.0;
-        auto& bus = busname_to_bus_.at(request);
-        for (std::size_t i = 1; i < bus->stops.size(); ++i) {
-            res += geo::ComputeDistance(bus->stops[i-1]->coordinates, bus->stops[i]->coordinates);
+        const Bus* bus = FindBus(request);
+        // Отрезки обрабатываются блоками в буферах на стеке, чтобы запрос не выделял память
+        constexpr std::size_t BLOCK_SIZE = 64;
+        std::array<geo::SpherePoint, BLOCK_SIZE + 1> points;
+        std::array<double, BLOCK_SIZE> distances;
+        double geo_length = 0.0;
+        for (std::size_t first = 0; first + 1 < bus->stops.size(); first += BLOCK_SIZE) {
+            const std::size_t count = std::min(BLOCK_SIZE, bus->stops.size() - 1 - first);
+            for (std::size_t i = 0; i <= count; ++i) {
+                points[i] = bus->stops[first + i]->sphere_point;
+            }
+            geo::ComputeDistances(points.data(), points.data() + 1, distances.data(), count);
+            geo_length = std::accumulate(distances.begin(), distances.begin() + count, geo_length);
         }
-        return res;
+        return geo_length;
     }
 
-    const std::deque<Bus>& TransportCatalogue::GetBuses() const {
+    const std::pmr::deque<Bus>& TransportCatalogue::GetBuses() const {
         return buses_;
     }
 
-    const std::deque<Stop>& TransportCatalogue::GetStops() const {
+    const std::pmr::deque<Stop>& TransportCatalogue::GetStops() const {
         return stops_;
     }
 
+    memory::Report TransportCatalogue::GetMemoryReport() const {
+        memory::Usage buses{"buses", buses_.size(), memory::GetHeapBytes(buses_)};
+        for (const Bus& bus : buses_) {
+            buses.bytes += memory::GetHeapBytes(bus.stops);
+        }
+        memory::Usage stop_buses{"stopname_to_busname", 0, memory::GetHashTableBytes(stopname_to_busname_)};
+        for (const auto& [stop_name, bus_names] : stopname_to_busname_) {
+            stop_buses.count += bus_names.size();
+            stop_buses.bytes += memory::GetHashTableBytes(bus_names);
+        }
+        return {
+            {"names", names_.GetSize(), names_.GetMemoryUsage()},
+            {"stops", stops_.size(), memory::GetHeapBytes(stops_)},
+            {"stopname_to_stop", stopname_to_stop_.size(), memory::GetHashTableBytes(stopname_to_stop_)},
+            {"distance_between_stops", distance_between_stops_.size(), memory::GetHashTableBytes(distance_between_stops_)},
+            std::move(buses),
+            {"busname_to_bus", busname_to_bus_.size(), memory::GetHashTableBytes(busname_to_bus_)},
+            std::move(stop_buses),
+            {"frozen_stops", frozen_stops_.GetEntries().size(), frozen_stops_.GetMemoryUsage()},
+            {"frozen_buses", frozen_buses_.GetEntries().size(), frozen_buses_.GetMemoryUsage()},
+            {"stop_search", is_frozen_ ? stops_.size() : 0, stop_search_.GetMemoryUsage()}
+        };
+    }
+
     BusInfo TransportCatalogue::GetBusInfo(const std::string_view request) const {
         return BusInfo({GetStopsOnRoute(request), GetUniqueStops(request), GetRouteLength(request), GetRouteLength(request) / GetCurvature(request)});
     }
 
-    const std::unordered_set<std::string_view>& TransportCatalogue::GetStopInfo(const std::string_view request) const {
+    const std::pmr::unordered_set<std::string_view>& TransportCatalogue::GetStopInfo(const std::string_view request) const {
+        static const BusNames empty_stop;
+        if (is_frozen_) {
+            const FrozenStop* stop = frozen_stops_.Find(request);
+            return stop != nullptr && stop->buses != nullptr ? *stop->buses : empty_stop;
+        }
         auto stop = stopname_to_busname_.find(request);
         if (stop == stopname_to_busname_.end()) {
-            static std::unordered_set<std::string_view> empty_stop; 
             return empty_stop;
         }
         return stop->second;
     }
 
+    void TransportCatalogue::Freeze() {
+        trace::Span span("Freeze", "ingest");
+        Unfreeze();
+        frozen_stops_.Build(GetStopEntries());
+        frozen_buses_.Build(GetBusEntries());
+        stop_search_.Build(GetStopMatches({}));
+        is_frozen_ = true;
+    }
+
+    void TransportCatalogue::Freeze(const FrozenNames& names) {
+        trace::Span span("Freeze", "ingest");
+        Unfreeze();
+        frozen_stops_.Build(GetStopEntries(), names.stops);
+        frozen_buses_.Build(GetBusEntries(), names.buses);
+        stop_search_.Build(GetStopMatches({}));
+        is_frozen_ = true;
+    }
+
+    bool TransportCatalogue::IsFrozen() const {
+        return is_frozen_;
+    }
+
+    FrozenNames TransportCatalogue::GetFrozenNames() const {
+        return {frozen_stops_.GetParameters(), frozen_buses_.GetParameters()};
+    }
+
+    std::vector<StopMatch> TransportCatalogue::SearchStops(std::string_view prefix, std::size_t limit) const {
+        if (is_frozen_) {
+            return stop_search_.Search(prefix, limit);
+        }
+        std::vector<StopMatch> matches = GetStopMatches(prefix);
+        const auto middle = matches.begin() + std::min(limit, matches.size());
+        std::partial_sort(matches.begin(), middle, matches.end(), IsBetterMatch);
+        matches.erase(middle, matches.end());
+        return matches;
+    }
+
+    bool TransportCatalogue::IsShadowed(const Stop& stop) const {
+        const auto first = stopname_to_stop_.find(stop.name);
+        return first == stopname_to_stop_.end() || first->second != &stop;
+    }
+
+    bool TransportCatalogue::IsShadowed(const Bus& bus) const {
+        const auto first = busname_to_bus_.find(bus.name);
+        return first == busname_to_bus_.end() || first->second != &bus;
+    }
+
+    void TransportCatalogue::Unfreeze() {
+        if (is_frozen_) {
+            is_frozen_ = false;
+            frozen_stops_.Clear();
+            frozen_buses_.Clear();
+            stop_search_.Clear();
+        }
+    }
+
+    std::vector<PerfectHashMap<TransportCatalogue::FrozenStop>::Entry> TransportCatalogue::GetStopEntries() const {
+        std::vector<PerfectHashMap<FrozenStop>::Entry> entries;
+        entries.reserve(stops_.size());
+        for (const Stop& stop : stops_) {
+            if (IsShadowed(stop)) {
+                continue;
+            }
+            auto buses = stopname_to_busname_.find(stop.name);
+            entries.push_back({stop.name, {&stop, buses != stopname_to_busname_.end() ? &buses->second : nullptr}});
+        }
+        return entries;
+    }
+
+    std::vector<StopMatch> TransportCatalogue::GetStopMatches(std::string_view prefix) const {
+        std::vector<StopMatch> matches;
+        for (const Stop& stop : stops_) {
+            if (!IsShadowed(stop) && stop.name.substr(0, prefix.size()) == prefix) {
+                matches.push_back({stop.name, GetStopInfo(stop.name).size()});
+            }
+        }
+        return matches;
+    }
+
+    std::vector<PerfectHashMap<const Bus*>::Entry> TransportCatalogue::GetBusEntries() const {
+        std::vector<PerfectHashMap<const Bus*>::Entry> entries;
+        entries.reserve(buses_.size());
+        for (const Bus& bus : buses_) {
+            if (!IsShadowed(bus)) {
+                entries.push_back({bus.name, &bus});
+            }
+        }
+        return entries;
+    }
+
 } // namespace transport_catalogue
\ No newline at end of file
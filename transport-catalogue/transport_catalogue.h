@@ -2,23 +2,51 @@
 
 #include <cassert>
 #include <deque>
+#include <memory_resource>
 #include <unordered_set>
 #include <unordered_map>
 #include <set>
 #include <optional>
 
 #include "domain.h"
+#include "memory_usage.h"
+#include "name_pool.h"
+#include "perfect_hash.h"
+#include "stop_search.h"
 
 namespace transport_catalogue {
 
     using namespace domain;
 
+    // Параметры совершенных хеш-функций замороженного справочника
+    struct FrozenNames {
+        PerfectHashParameters stops;
+        PerfectHashParameters buses;
+    };
+
     class TransportCatalogue {
     public:
+        // Все контейнеры справочника, включая остановки автобусов, берут память из resource.
+        // Например, из арены, которая освобождается целиком вместе со справочником
+        explicit TransportCatalogue(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+        // Копия other в ресурсе resource с тем же порядком остановок и автобусов.
+        // Копия замороженного справочника тоже заморожена
+        TransportCatalogue(const TransportCatalogue& other, std::pmr::memory_resource* resource);
+
+        TransportCatalogue(const TransportCatalogue&) = delete;
+        TransportCatalogue& operator=(const TransportCatalogue&) = delete;
+
         void AddStop(const Stop& stop);
 
         const Stop* FindStop(const std::string_view stop_name) const;
 
+        void SetStopCoordinates(const std::string_view stop_name, Coordinates coordinates);
+
+        // Удаляет остановку, через которую не проходит ни один автобус.
+        // Указатели на остальные остановки могут измениться
+        void RemoveStop(const std::string_view stop_name);
+
         void SetDistanceBetweenStops(const Stop* stop1, const Stop* stop2, int distance);
 
         int GetDistanceBetweenStops(const Stop* stop1, const Stop* stop2) const;
@@ -27,23 +55,63 @@ namespace transport_catalogue {
 
         const Bus* FindBus(const std::string_view bus_name) const;
 
+        // Удаляет автобус. Указатели на остальные автобусы могут измениться
+        void RemoveBus(const std::string_view bus_name);
+
         BusInfo GetBusInfo(const std::string_view request) const;
 
-        const std::unordered_set<std::string_view>& GetStopInfo(const std::string_view request) const;
+        const std::pmr::unordered_set<std::string_view>& GetStopInfo(const std::string_view request) const;
 
-        const std::deque<Bus>& GetBuses() const;
+        const std::pmr::deque<Bus>& GetBuses() const;
         
-        const std::deque<Stop>& GetStops() const;
+        const std::pmr::deque<Stop>& GetStops() const;
 
-    private:
-        std::deque<Stop> stops_;
-        std::unordered_map<std::string_view, const Stop*> stopname_to_stop_;
-        std::unordered_map<std::pair<const Stop*, const Stop*>, int, PairHasher, PairEqual> distance_between_stops_;
+        // Строит совершенные хеш-функции по именам остановок и автобусов, после чего поиск
+        // по имени обходится без хеш-таблиц. Любое добавление или удаление снимает заморозку
+        void Freeze();
+        // То же по сохранённым параметрам, без подбора смещений
+        void Freeze(const FrozenNames& names);
+        bool IsFrozen() const;
+        FrozenNames GetFrozenNames() const;
 
-        std::deque<Bus> buses_;
-        std::unordered_map<std::string_view, const Bus*> busname_to_bus_;
+        // Не более limit остановок, названия которых начинаются с prefix, по убыванию
+        // числа автобусов. У замороженного справочника ищется по индексу
+        std::vector<StopMatch> SearchStops(std::string_view prefix, std::size_t limit) const;
 
-        std::unordered_map<std::string_view, std::unordered_set<std::string_view>> stopname_to_busname_;
+        // Память, занятая остановками, автобусами, расстояниями и индексами по именам
+        memory::Report GetMemoryReport() const;
+
+    private:
+        using BusNames = std::pmr::unordered_set<std::string_view>;
+
+        struct FrozenStop {
+            const Stop* stop = nullptr;
+            const BusNames* buses = nullptr;
+        };
+
+        NamePool names_;
+        std::pmr::deque<Stop> stops_;
+        std::pmr::unordered_map<std::string_view, const Stop*> stopname_to_stop_;
+        std::pmr::unordered_map<std::pair<const Stop*, const Stop*>, int, PairHasher, PairEqual> distance_between_stops_;
+
+        std::pmr::deque<Bus> buses_;
+        std::pmr::unordered_map<std::string_view, const Bus*> busname_to_bus_;
+
+        std::pmr::unordered_map<std::string_view, BusNames> stopname_to_busname_;
+
+        bool is_frozen_ = false;
+        PerfectHashMap<FrozenStop> frozen_stops_;
+        PerfectHashMap<const Bus*> frozen_buses_;
+        StopSearchIndex stop_search_;
+
+        void Unfreeze();
+        // Повторно добавленное имя не заменяет первую запись с ним, поиск по имени находит первую.
+        // Такие повторы не попадают в совершенные хеш-функции и индекс поиска
+        bool IsShadowed(const Stop& stop) const;
+        bool IsShadowed(const Bus& bus) const;
+        std::vector<PerfectHashMap<FrozenStop>::Entry> GetStopEntries() const;
+        std::vector<PerfectHashMap<const Bus*>::Entry> GetBusEntries() const;
+        std::vector<StopMatch> GetStopMatches(std::string_view prefix) const;
 
         std::size_t GetStopsOnRoute(const std::string_view request) const;
         std::size_t GetUniqueStops(const std::string_view request) const;
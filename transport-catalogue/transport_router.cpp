@@ -1,5 +1,9 @@
 #include "transport_router.h"
+#include "parallel.h"
+#include "metrics.h"
+#include "trace.h"
 
+#include <algorithm>
 #include <utility>
 #include <string>
 #include <vector>
@@ -13,112 +17,744 @@ namespace transport_router {
         catalogue_(catalogue)
     {}
 
+    TransportRouter::TransportRouter(const TransportRouter& other, const TransportCatalogue& catalogue) :
+        catalogue_(catalogue),
+        settings_(other.settings_),
+        vertex_points_(other.vertex_points_),
+        min_distance_ratio_(other.min_distance_ratio_),
+        is_graph_prepared_(other.is_graph_prepared_)
+    {
+        if (other.transport_graph_) {
+            transport_graph_ = std::make_unique<graph::DirectedWeightedGraph<double>>(*other.transport_graph_);
+        }
+        if (other.transport_router_) {
+            transport_router_ = std::make_unique<graph::Router<double>>(*other.transport_router_, *transport_graph_);
+        }
+        if (other.tree_cache_) {
+            tree_cache_ = std::make_unique<graph::ShortestPathTreeCache<double>>(
+                settings_.tree_cache_bytes, transport_graph_->GetVertexCount());
+        }
+        if (other.contraction_hierarchy_) {
+            contraction_hierarchy_ = std::make_unique<graph::ContractionHierarchy<double>>(*other.contraction_hierarchy_);
+        }
+        // Данные RAPTOR ссылаются на имена справочника и строятся быстро
+        if (other.raptor_) {
+            raptor_ = std::make_unique<Raptor>(catalogue_, settings_.bus_wait_time, settings_.bus_velocity);
+        }
+
+        stop_to_vertex_.reserve(other.stop_to_vertex_.size());
+        for (const auto& [stop_name, vertices] : other.stop_to_vertex_) {
+            stop_to_vertex_.insert({GetStopName(stop_name), vertices});
+        }
+        vertex_to_stop_.reserve(other.vertex_to_stop_.size());
+        for (const auto& [vertex, stop_name] : other.vertex_to_stop_) {
+            vertex_to_stop_.insert({vertex, GetStopName(stop_name)});
+        }
+        edge_to_item_.reserve(other.edge_to_item_.size());
+        for (const auto& [edge, item] : other.edge_to_item_) {
+            Item copy = item;
+            copy.name = item.type == "Wait" ? GetStopName(item.name) : GetBusName(item.name);
+            edge_to_item_.insert({edge, copy});
+        }
+        bus_to_edges_.reserve(other.bus_to_edges_.size());
+        for (const auto& [bus_name, edges] : other.bus_to_edges_) {
+            bus_to_edges_.insert({GetBusName(bus_name), edges});
+        }
+    }
+
     void TransportRouter::SetSettingsAndBuild(RouteSettings settings) {
+        static auto& build_time = metrics::GetPhaseHistogram("router_build");
+        metrics::ScopedTimer timer(build_time);
+        trace::Span span("SetSettingsAndBuild", "build");
         settings_ = std::move(settings);
         BuildRoute();
     }
 
     std::optional<RouteItems> TransportRouter::GetRouteInfo(const std::string_view from, const std::string_view to) const {
-        RouteItems items_info;
+        if (raptor_) {
+            return GetRaptorRouteInfo(from, to);
+        }
+
+        const auto from_vertex = FindStopVertex(from);
+        const auto to_vertex = FindStopVertex(to);
+        if (!from_vertex || !to_vertex) {
+            return std::nullopt;
+        }
+
+        if (tree_cache_) {
+            const auto tree = tree_cache_->Get(*transport_graph_, *from_vertex);
+            if (auto route = tree->BuildRoute(*to_vertex)) {
+                return MakeRouteItems(route->weight, route->edges);
+            }
+            return std::nullopt;
+        }
 
-        auto from_stop = catalogue_.FindStop(from);
-        auto to_stop = catalogue_.FindStop(to);
+        if (contraction_hierarchy_) {
+            if (auto route = contraction_hierarchy_->BuildRoute(*from_vertex, *to_vertex)) {
+                return MakeRouteItems(route->weight, route->edges);
+            }
+            return std::nullopt;
+        }
 
-        auto from_vertex = GetVertexFromStop(from_stop);
-        auto to_vertex = GetVertexFromStop(to_stop);
+        if (settings_.engine == RouteEngine::A_STAR) {
+            auto route = graph::FindRouteAStar(*transport_graph_, *from_vertex, *to_vertex,
+                [this, to = *to_vertex](graph::VertexId vertex) {
+                    return EstimateRouteTime(vertex, to);
+                });
+            if (route) {
+                return MakeRouteItems(route->weight, route->edges);
+            }
+            return std::nullopt;
+        }
+
+        if (settings_.engine == RouteEngine::BIDIRECTIONAL) {
+            if (auto route = graph::FindRouteBidirectional(*transport_graph_, *from_vertex, *to_vertex)) {
+                return MakeRouteItems(route->weight, route->edges);
+            }
+            return std::nullopt;
+        }
 
         auto router_info = transport_router_->BuildRoute(
-            from_vertex.first,
-            to_vertex.first
+            *from_vertex,
+            *to_vertex
         );
 
         if (router_info.has_value()) {
-            items_info.total_time = router_info.value().weight;
-            for (const auto& edge : router_info.value().edges) {
-                items_info.items.push_back(edge_to_item_.at(edge));
-            }
-            return items_info;
+            return MakeRouteItems(router_info->weight, router_info->edges);
         }
 
         return std::nullopt;
     }
 
+    std::vector<RouteItems> TransportRouter::GetRouteAlternatives(const std::string_view from, const std::string_view to,
+                                                                  std::size_t count) const {
+        std::vector<RouteItems> alternatives;
+        if (raptor_) {
+            if (auto route = GetRaptorRouteInfo(from, to); route && count > 0) {
+                alternatives.push_back(std::move(*route));
+            }
+            return alternatives;
+        }
+
+        const auto from_vertex = FindStopVertex(from);
+        const auto to_vertex = FindStopVertex(to);
+        if (!from_vertex || !to_vertex) {
+            return alternatives;
+        }
+        // Некольцевой маршрут хранит путь туда и обратно, и рёбра обратного направления повторяют
+        // рёбра прямого. Рёбра с одинаковыми концами и элементом маршрута дают один и тот же вариант
+        auto same_edge = [this](graph::EdgeId lhs, graph::EdgeId rhs) {
+            if (lhs == rhs) {
+                return true;
+            }
+            const auto& lhs_edge = transport_graph_->GetEdge(lhs);
+            const auto& rhs_edge = transport_graph_->GetEdge(rhs);
+            const Item& lhs_item = edge_to_item_.at(lhs);
+            const Item& rhs_item = edge_to_item_.at(rhs);
+            return lhs_edge.from == rhs_edge.from && lhs_edge.to == rhs_edge.to && lhs_edge.weight == rhs_edge.weight
+                && lhs_item.type == rhs_item.type && lhs_item.name == rhs_item.name && lhs_item.span == rhs_item.span;
+        };
+        for (const auto& route : graph::FindKShortestRoutes(*transport_graph_, *from_vertex, *to_vertex, count, same_edge)) {
+            alternatives.push_back(MakeRouteItems(route.weight, route.edges));
+        }
+        return alternatives;
+    }
+
+    RouteMatrix TransportRouter::GetRouteMatrix(const std::vector<std::string_view>& from,
+                                                const std::vector<std::string_view>& to) const {
+        if (raptor_) {
+            return GetRaptorRouteMatrix(from, to);
+        }
+
+        std::vector<std::optional<graph::VertexId>> to_vertices;
+        to_vertices.reserve(to.size());
+        for (const auto stop_name : to) {
+            to_vertices.push_back(FindStopVertex(stop_name));
+        }
+
+        RouteMatrix matrix(from.size(), std::vector<std::optional<double>>(to.size()));
+        parallel::ParallelFor(from.size(), [&](std::size_t i) {
+            const auto from_vertex = FindStopVertex(from[i]);
+            if (!from_vertex) {
+                return;
+            }
+            auto& row = matrix[i];
+            if (transport_router_ || contraction_hierarchy_) {
+                for (std::size_t j = 0; j < to_vertices.size(); ++j) {
+                    if (to_vertices[j]) {
+                        row[j] = GetRouteTime(*from_vertex, *to_vertices[j]);
+                    }
+                }
+                return;
+            }
+            // Деревья строятся в обход кэша, чтобы матрица не вытесняла из него деревья частых запросов
+            const graph::ShortestPathTree<double> tree(*transport_graph_, *from_vertex);
+            for (std::size_t j = 0; j < to_vertices.size(); ++j) {
+                if (to_vertices[j]) {
+                    row[j] = tree.GetWeight(*to_vertices[j]);
+                }
+            }
+        });
+        return matrix;
+    }
+
+    std::optional<double> TransportRouter::GetRouteTime(graph::VertexId from, graph::VertexId to) const {
+        if (contraction_hierarchy_) {
+            return contraction_hierarchy_->GetRouteWeight(from, to);
+        }
+        return transport_router_->GetRouteWeight(from, to);
+    }
+
+    double TransportRouter::EstimateRouteTime(graph::VertexId from, graph::VertexId to) const {
+        if (from == to) {
+            return 0.0;
+        }
+        const VertexPoint& from_point = vertex_points_[from];
+        const double distance = geo::ComputeDistance(from_point.point, vertex_points_[to].point);
+        // Запас на погрешность вычислений, чтобы оценка не превысила точное время пути
+        double time = DistanceIntoTime(distance * min_distance_ratio_) * (1.0 - 1e-9);
+        // С другой остановки нельзя уехать, не дождавшись автобуса
+        if (from_point.is_wait_begin) {
+            time += settings_.bus_wait_time;
+        }
+        return time;
+    }
+
+    std::optional<std::vector<ReachableStop>> TransportRouter::GetIsochrone(const std::string_view from,
+                                                                            double max_time) const {
+        if (raptor_) {
+            return GetRaptorIsochrone(from, max_time);
+        }
+
+        const auto from_vertex = FindStopVertex(from);
+        if (!from_vertex) {
+            return std::nullopt;
+        }
+        std::vector<ReachableStop> stops;
+        // Остановка достигнута, когда достигнута вершина начала ожидания на ней
+        for (const auto& [vertex, time] : graph::FindReachableVertices(*transport_graph_, *from_vertex, max_time)) {
+            if (auto stop = vertex_to_stop_.find(vertex); stop != vertex_to_stop_.end()) {
+                stops.push_back({stop->second, time});
+            }
+        }
+        std::stable_sort(stops.begin(), stops.end(), [](const ReachableStop& lhs, const ReachableStop& rhs) {
+            return lhs.time < rhs.time || (lhs.time == rhs.time && lhs.name < rhs.name);
+        });
+        return stops;
+    }
+
+    std::optional<RouteItems> TransportRouter::GetRaptorRouteInfo(const std::string_view from, const std::string_view to) const {
+        const auto from_stop = raptor_->FindStop(from);
+        const auto to_stop = raptor_->FindStop(to);
+        if (!from_stop || !to_stop) {
+            return std::nullopt;
+        }
+        const auto journey = raptor_->FindJourney(*from_stop, *to_stop);
+        if (!journey) {
+            return std::nullopt;
+        }
+        return MakeRouteItems(*raptor_, *journey);
+    }
+
+    RouteItems TransportRouter::MakeRouteItems(const Raptor& raptor, const Raptor::Journey& journey) const {
+        RouteItems items_info;
+        items_info.total_time = journey.total_time;
+        for (const auto& leg : journey.legs) {
+            items_info.items.push_back({"Wait", raptor.GetStopName(leg.stop), settings_.bus_wait_time, 1});
+            items_info.items.push_back({"Bus", raptor.GetBusName(leg.bus), leg.ride_time, leg.span_count});
+        }
+        return items_info;
+    }
+
+    std::vector<RouteItems> TransportRouter::GetParetoRoutes(const std::string_view from, const std::string_view to,
+                                                             std::size_t max_transfers) const {
+        const Raptor& raptor = GetParetoRaptor();
+        std::vector<RouteItems> routes;
+        const auto from_stop = raptor.FindStop(from);
+        const auto to_stop = raptor.FindStop(to);
+        if (!from_stop || !to_stop) {
+            return routes;
+        }
+        for (const auto& journey : raptor.FindParetoJourneys(*from_stop, *to_stop, max_transfers)) {
+            routes.push_back(MakeRouteItems(raptor, journey));
+        }
+        return routes;
+    }
+
+    const Raptor& TransportRouter::GetParetoRaptor() const {
+        if (raptor_) {
+            return *raptor_;
+        }
+        std::lock_guard guard(pareto_raptor_mutex_);
+        if (!pareto_raptor_) {
+            pareto_raptor_ = std::make_unique<Raptor>(catalogue_, settings_.bus_wait_time, settings_.bus_velocity);
+        }
+        return *pareto_raptor_;
+    }
+
+    RouteMatrix TransportRouter::GetRaptorRouteMatrix(const std::vector<std::string_view>& from,
+                                                      const std::vector<std::string_view>& to) const {
+        RouteMatrix matrix(from.size(), std::vector<std::optional<double>>(to.size()));
+        parallel::ParallelFor(from.size(), [&](std::size_t i) {
+            const auto from_stop = raptor_->FindStop(from[i]);
+            if (!from_stop) {
+                return;
+            }
+            const auto times = raptor_->GetArrivalTimes(*from_stop);
+            for (std::size_t j = 0; j < to.size(); ++j) {
+                if (const auto to_stop = raptor_->FindStop(to[j])) {
+                    matrix[i][j] = times[*to_stop];
+                }
+            }
+        });
+        return matrix;
+    }
+
+    std::optional<std::vector<ReachableStop>> TransportRouter::GetRaptorIsochrone(const std::string_view from,
+                                                                                  double max_time) const {
+        const auto from_stop = raptor_->FindStop(from);
+        if (!from_stop) {
+            return std::nullopt;
+        }
+        const auto times = raptor_->GetArrivalTimes(*from_stop, max_time);
+        std::vector<ReachableStop> stops;
+        for (std::size_t stop = 0; stop < times.size(); ++stop) {
+            if (times[stop]) {
+                stops.push_back({raptor_->GetStopName(stop), *times[stop]});
+            }
+        }
+        std::sort(stops.begin(), stops.end(), [](const ReachableStop& lhs, const ReachableStop& rhs) {
+            return lhs.time < rhs.time || (lhs.time == rhs.time && lhs.name < rhs.name);
+        });
+        return stops;
+    }
+
+    RouteItems TransportRouter::MakeRouteItems(double total_time, const std::vector<graph::EdgeId>& edges) const {
+        RouteItems items_info;
+        items_info.total_time = total_time;
+        for (const auto& edge : edges) {
+            items_info.items.push_back(edge_to_item_.at(edge));
+        }
+        return items_info;
+    }
+
+    std::optional<graph::ShortestPathTreeCache<double>::Stats> TransportRouter::GetTreeCacheStats() const {
+        if (!tree_cache_) {
+            return std::nullopt;
+        }
+        return tree_cache_->GetStats();
+    }
+
+    std::optional<graph::ContractionHierarchy<double>::Stats> TransportRouter::GetContractionStats() const {
+        if (!contraction_hierarchy_) {
+            return std::nullopt;
+        }
+        return contraction_hierarchy_->GetStats();
+    }
+
+    memory::Report TransportRouter::GetMemoryReport() const {
+        memory::Report report;
+        if (transport_graph_) {
+            memory::Append(report, "graph.", transport_graph_->GetMemoryReport());
+        }
+        if (transport_router_) {
+            memory::Usage usage = transport_router_->GetMemoryUsage();
+            usage.name.insert(0, "router.");
+            report.push_back(std::move(usage));
+        }
+
+        memory::Usage bus_edges{"bus_to_edges", 0, memory::GetHashTableBytes(bus_to_edges_)};
+        for (const auto& [name, edges] : bus_to_edges_) {
+            bus_edges.count += edges.size();
+            bus_edges.bytes += memory::GetHeapBytes(edges);
+        }
+        report.push_back({"edge_to_item", edge_to_item_.size(), memory::GetHashTableBytes(edge_to_item_)});
+        report.push_back({"stop_to_vertex", stop_to_vertex_.size(), memory::GetHashTableBytes(stop_to_vertex_)});
+        report.push_back({"vertex_to_stop", vertex_to_stop_.size(), memory::GetHashTableBytes(vertex_to_stop_)});
+        report.push_back(std::move(bus_edges));
+        report.push_back({"vertex_points", vertex_points_.size(), memory::GetHeapBytes(vertex_points_)});
+
+        if (tree_cache_) {
+            const auto stats = tree_cache_->GetStats();
+            report.push_back({"tree_cache", stats.trees, stats.bytes});
+        }
+        if (contraction_hierarchy_) {
+            const auto& stats = contraction_hierarchy_->GetStats();
+            report.push_back({"contraction_hierarchy", stats.original_arcs + stats.shortcuts, stats.memory_bytes});
+        }
+        if (raptor_) {
+            report.push_back({"raptor", raptor_->GetStopCount(), raptor_->GetMemoryUsage()});
+        }
+        std::lock_guard guard(pareto_raptor_mutex_);
+        if (pareto_raptor_) {
+            report.push_back({"pareto_raptor", pareto_raptor_->GetStopCount(), pareto_raptor_->GetMemoryUsage()});
+        }
+        return report;
+    }
+
     double TransportRouter::DistanceIntoTime(double distance) const {
         return (distance * 60) / (settings_.bus_velocity * 1000);
     }
 
     const std::pair<graph::VertexId, graph::VertexId>& TransportRouter::GetVertexFromStop(const Stop* stop) const {
-        auto vertex = stop_to_vertex_.find(stop);
+        auto vertex = stop_to_vertex_.find(stop->name);
         return vertex->second;
     }
 
+    std::optional<graph::VertexId> TransportRouter::FindStopVertex(const std::string_view stop_name) const {
+        auto vertex = stop_to_vertex_.find(stop_name);
+        if (vertex == stop_to_vertex_.end()) {
+            return std::nullopt;
+        }
+        return vertex->second.first;
+    }
+
+    std::string_view TransportRouter::GetStopName(const std::string_view stop_name) const {
+        return catalogue_.FindStop(stop_name)->name;
+    }
+
+    std::string_view TransportRouter::GetBusName(const std::string_view bus_name) const {
+        return catalogue_.FindBus(bus_name)->name;
+    }
+
     void TransportRouter::AddStopsIntoGraph() {
         std::size_t v = 0;
-        auto stops = catalogue_.GetStops();
+        const auto& stops = catalogue_.GetStops();
 
         for (const Stop& stop : stops) {
-            auto find_stop = catalogue_.FindStop(stop.name);
-            stop_to_vertex_.insert({find_stop, {v, v + 1}});
-
-            graph::EdgeId edge = transport_graph_->AddEdge({v, v + 1, settings_.bus_wait_time});
-            Item item({"Wait", stop.name, settings_.bus_wait_time, 1});
-            edge_to_item_.insert({edge, item});
-
+            AddStopIntoGraph(stop, v, v + 1);
             v += 2;
         }
     }
 
-    void TransportRouter::AddBusEdgeIntoGraph(
+    graph::EdgeId TransportRouter::AddStopIntoGraph(const Stop& stop, graph::VertexId wait_begin, graph::VertexId wait_end) {
+        stop_to_vertex_.insert({stop.name, {wait_begin, wait_end}});
+        vertex_to_stop_.insert({wait_begin, stop.name});
+        if (vertex_points_.size() <= std::max(wait_begin, wait_end)) {
+            vertex_points_.resize(std::max(wait_begin, wait_end) + 1);
+        }
+        vertex_points_[wait_begin] = {stop.sphere_point, true};
+        vertex_points_[wait_end] = {stop.sphere_point, false};
+
+        // У подготовленного графа время ожидания ещё неизвестно
+        const double wait_time = is_graph_prepared_ ? 0.0 : settings_.bus_wait_time;
+        graph::EdgeId edge = transport_graph_->AddEdge({wait_begin, wait_end, wait_time});
+        Item item({"Wait", stop.name, wait_time, 1});
+        edge_to_item_.insert({edge, item});
+        return edge;
+    }
+
+    graph::EdgeId TransportRouter::AddBusEdgeIntoGraph(
         const Stop* from, 
         const Stop* to,
         const std::string_view bus_name,
         int span_count,
-        double distance
+        double time
     ) {
-        Item item({"Bus", std::string(bus_name), DistanceIntoTime(distance), span_count});
+        Item item({"Bus", bus_name, time, span_count});
 
         auto from_vertex = GetVertexFromStop(from);
         auto to_vertex = GetVertexFromStop(to);
 
-        graph::EdgeId edge = transport_graph_->AddEdge({from_vertex.second, to_vertex.first, DistanceIntoTime(distance)});
+        graph::EdgeId edge = transport_graph_->AddEdge({from_vertex.second, to_vertex.first, time});
         edge_to_item_.insert({edge, item});
+        return edge;
+    }
+
+    void TransportRouter::PrepareStop(const Stop& stop) {
+        if (!is_graph_prepared_) {
+            ResetGraph(0);
+            is_graph_prepared_ = true;
+        }
+        const graph::VertexId wait_begin = transport_graph_->AddVertex();
+        const graph::VertexId wait_end = transport_graph_->AddVertex();
+        AddStopIntoGraph(stop, wait_begin, wait_end);
+    }
+
+    void TransportRouter::PrepareBus(const Bus& bus) {
+        if (!is_graph_prepared_) {
+            ResetGraph(0);
+            is_graph_prepared_ = true;
+        }
+        AddBusIntoGraph(bus);
     }
 
     void TransportRouter::AddBusIntoGraph(const Bus& bus) {
-        for (std::size_t i = 0; i < (bus.stops.size() - 1); ++i) {
+        const BusSpans spans = GetBusSpans(bus);
+        min_distance_ratio_ = std::min(min_distance_ratio_, spans.min_distance_ratio);
+
+        auto& bus_edges = bus_to_edges_[bus.name];
+        bus_edges.reserve(bus_edges.size() + spans.spans.size());
+        for (const BusSpan& span : spans.spans) {
+            const double time = is_graph_prepared_ ? 0.0 : DistanceIntoTime(span.distance);
+            bus_edges.push_back(AddBusEdgeIntoGraph(span.from, span.to, bus.name, span.span_count, time));
+        }
+    }
+
+    TransportRouter::BusSpans TransportRouter::GetBusSpans(const Bus& bus) const {
+        BusSpans result;
+        const std::size_t stop_count = bus.stops.size();
+        if (stop_count < 2) {
+            return result;
+        }
+        result.spans.reserve(stop_count * (stop_count - 1) / 2 * (bus.is_roundtrip ? 1 : 2));
+        for (std::size_t i = 0; i + 1 < stop_count; ++i) {
             double from_to_distance = 0.0;
             double to_from_distance = 0.0;
 
             const Stop* i_from = bus.stops[i];
 
-            for (std::size_t j = i; j < (bus.stops.size() - 1); ++j) {
+            for (std::size_t j = i; j < (stop_count - 1); ++j) {
                 const Stop* from = bus.stops[j];
                 const Stop* to = bus.stops[j + 1];
+                const int span_count = static_cast<int>(j + 1 - i);
 
                 from_to_distance += catalogue_.GetDistanceBetweenStops(from, to);
-                AddBusEdgeIntoGraph(i_from, to, bus.name, j + 1 - i, from_to_distance);
+                result.spans.push_back({i_from, to, span_count, from_to_distance});
 
                 if (!bus.is_roundtrip) {
                     to_from_distance += catalogue_.GetDistanceBetweenStops(to, from);
-                    AddBusEdgeIntoGraph(to, i_from, bus.name, j + 1 - i, to_from_distance);
+                    result.spans.push_back({to, i_from, span_count, to_from_distance});
                 }
 
             }
         }
+        result.min_distance_ratio = GetMinDistanceRatio(bus);
+        return result;
+    }
+
+    double TransportRouter::GetMinDistanceRatio(const Bus& bus) const {
+        double min_distance_ratio = std::numeric_limits<double>::infinity();
+        for (std::size_t i = 0; i + 1 < bus.stops.size(); ++i) {
+            min_distance_ratio = std::min(min_distance_ratio, GetDistanceRatio(bus.stops[i], bus.stops[i + 1]));
+        }
+        return min_distance_ratio;
+    }
+
+    double TransportRouter::GetDistanceRatio(const Stop* from, const Stop* to) const {
+        const double geo_distance = geo::ComputeDistance(from->sphere_point, to->sphere_point);
+        if (geo_distance <= 0.0) {
+            return std::numeric_limits<double>::infinity();
+        }
+        double ratio = catalogue_.GetDistanceBetweenStops(from, to) / geo_distance;
+        if (from != to) {
+            ratio = std::min(ratio, catalogue_.GetDistanceBetweenStops(to, from) / geo_distance);
+        }
+        return ratio;
+    }
+
+    std::vector<graph::EdgeId> TransportRouter::RemoveBusFromGraph(const std::string_view bus_name) {
+        auto bus_edges = bus_to_edges_.find(bus_name);
+        if (bus_edges == bus_to_edges_.end()) {
+            return {};
+        }
+        std::vector<graph::EdgeId> removed = std::move(bus_edges->second);
+        bus_to_edges_.erase(bus_edges);
+        for (const graph::EdgeId edge : removed) {
+            transport_graph_->RemoveEdge(edge);
+            edge_to_item_.erase(edge);
+        }
+        return removed;
     }
 
     void TransportRouter::BuildRoute() {
-        transport_graph_ = std::make_unique<graph::DirectedWeightedGraph<double>>(
-            catalogue_.GetStops().size() * 2
-        );
-        AddStopsIntoGraph();
+        raptor_.reset();
+        pareto_raptor_.reset();
+        if (settings_.engine == RouteEngine::RAPTOR) {
+            // Граф не нужен: поиск идёт по последовательностям остановок автобусов
+            transport_graph_.reset();
+            transport_router_.reset();
+            tree_cache_.reset();
+            contraction_hierarchy_.reset();
+            is_graph_prepared_ = false;
+            trace::Span span("raptor_index", "build");
+            raptor_ = std::make_unique<Raptor>(catalogue_, settings_.bus_wait_time, settings_.bus_velocity);
+            return;
+        }
+
+        if (is_graph_prepared_) {
+            trace::Span span("graph_weights", "build");
+            SetPreparedWeights();
+        } else {
+            trace::Span span("graph_construction", "build");
+            ResetGraph(catalogue_.GetStops().size() * 2);
+            AddStopsIntoGraph();
+
+            const auto& buses = catalogue_.GetBuses();
+            for (const Bus& bus : buses) {
+                AddBusIntoGraph(bus);
+            }
+        }
+
+        transport_router_.reset();
+        tree_cache_.reset();
+        contraction_hierarchy_.reset();
+        trace::Span span("router_precompute", "build");
+        switch (settings_.engine) {
+            case RouteEngine::ALL_PAIRS:
+                transport_router_ = std::make_unique<graph::Router<double>>(*transport_graph_);
+                break;
+            case RouteEngine::DIJKSTRA:
+                tree_cache_ = std::make_unique<graph::ShortestPathTreeCache<double>>(
+                    settings_.tree_cache_bytes, transport_graph_->GetVertexCount());
+                break;
+            case RouteEngine::CONTRACTION_HIERARCHIES:
+                contraction_hierarchy_ = std::make_unique<graph::ContractionHierarchy<double>>(*transport_graph_);
+                break;
+            case RouteEngine::A_STAR:
+            case RouteEngine::BIDIRECTIONAL:
+            case RouteEngine::RAPTOR:
+                break;
+        }
+    }
+
+    void TransportRouter::ResetGraph(std::size_t vertex_count) {
+        stop_to_vertex_.clear();
+        vertex_to_stop_.clear();
+        vertex_points_.clear();
+        min_distance_ratio_ = 1.0;
+        edge_to_item_.clear();
+        bus_to_edges_.clear();
+        transport_graph_ = std::make_unique<graph::DirectedWeightedGraph<double>>(vertex_count);
+    }
+
+    void TransportRouter::SetPreparedWeights() {
+        for (auto& [edge, item] : edge_to_item_) {
+            if (item.type == "Wait") {
+                item.time = settings_.bus_wait_time;
+                transport_graph_->SetEdgeWeight(edge, item.time);
+            }
+        }
+        // Расстояния могли измениться после PrepareBus повторной командой Stop, поэтому время
+        // рёбер считается по текущим расстояниям. Автобусы в справочнике идут в порядке
+        // PrepareBus, а рёбра каждого - в порядке перегонов GetBusSpans
+        min_distance_ratio_ = 1.0;
+        std::unordered_map<std::string_view, std::size_t> next_edge;
+        for (const Bus& bus : catalogue_.GetBuses()) {
+            const BusSpans spans = GetBusSpans(bus);
+            min_distance_ratio_ = std::min(min_distance_ratio_, spans.min_distance_ratio);
+            const auto& bus_edges = bus_to_edges_.at(bus.name);
+            std::size_t& edge_index = next_edge[bus.name];
+            for (const BusSpan& span : spans.spans) {
+                const graph::EdgeId edge = bus_edges[edge_index++];
+                Item& item = edge_to_item_.at(edge);
+                item.time = DistanceIntoTime(span.distance);
+                transport_graph_->SetEdgeWeight(edge, item.time);
+            }
+        }
+        is_graph_prepared_ = false;
+    }
+
+    void TransportRouter::UpdateRoutes(const std::vector<graph::EdgeId>& added_edges,
+                                       const std::vector<graph::EdgeId>& removed_edges) {
+        if (transport_router_) {
+            transport_router_->Update(added_edges, removed_edges);
+        }
+        if (tree_cache_) {
+            tree_cache_->Clear();
+        }
+        pareto_raptor_.reset();
+        // Иерархия не обновляется частично и строится заново
+        if (contraction_hierarchy_) {
+            contraction_hierarchy_ = std::make_unique<graph::ContractionHierarchy<double>>(*transport_graph_);
+        }
+    }
+
+    void TransportRouter::AddStop(const std::string_view stop_name) {
+        // Данные RAPTOR строятся быстро и не обновляются частично
+        if (raptor_) {
+            BuildRoute();
+            return;
+        }
+        const Stop* stop = catalogue_.FindStop(stop_name);
+        const graph::VertexId wait_begin = transport_graph_->AddVertex();
+        const graph::VertexId wait_end = transport_graph_->AddVertex();
+        const graph::EdgeId edge = AddStopIntoGraph(*stop, wait_begin, wait_end);
+        UpdateRoutes({edge}, {});
+    }
 
-        auto buses = catalogue_.GetBuses();
-        for (const Bus& bus : buses) {
-            AddBusIntoGraph(bus);
+    void TransportRouter::RemoveStop(const std::string_view stop_name) {
+        // Данные RAPTOR строятся быстро и не обновляются частично
+        if (raptor_) {
+            BuildRoute();
+            return;
         }
+        auto vertex = stop_to_vertex_.find(stop_name);
+        if (vertex == stop_to_vertex_.end()) {
+            return;
+        }
+        // Вершины удалённой остановки остаются в графе без рёбер
+        std::vector<graph::EdgeId> removed;
+        for (const auto stop_vertex : {vertex->second.first, vertex->second.second}) {
+            for (const graph::EdgeId edge : transport_graph_->GetIncidentEdges(stop_vertex)) {
+                removed.push_back(edge);
+            }
+        }
+        for (const graph::EdgeId edge : removed) {
+            transport_graph_->RemoveEdge(edge);
+            edge_to_item_.erase(edge);
+        }
+        vertex_to_stop_.erase(vertex->second.first);
+        stop_to_vertex_.erase(vertex);
+        UpdateRoutes({}, removed);
+    }
 
-        transport_router_ = std::make_unique<graph::Router<double>>(*transport_graph_);
+    void TransportRouter::UpdateBus(const std::string_view bus_name) {
+        // Данные RAPTOR строятся быстро и не обновляются частично
+        if (raptor_) {
+            BuildRoute();
+            return;
+        }
+        const std::vector<graph::EdgeId> removed = RemoveBusFromGraph(bus_name);
+        std::vector<graph::EdgeId> added;
+        if (const Bus* bus = catalogue_.FindBus(bus_name)) {
+            AddBusIntoGraph(*bus);
+            added = bus_to_edges_.at(bus->name);
+        }
+        UpdateRoutes(added, removed);
+    }
+
+    void TransportRouter::UpdateDistance(const std::string_view from, const std::string_view to) {
+        // Данные RAPTOR строятся быстро и не обновляются частично
+        if (raptor_) {
+            BuildRoute();
+            return;
+        }
+        const auto& from_buses = catalogue_.GetStopInfo(from);
+        const auto& to_buses = catalogue_.GetStopInfo(to);
+        std::vector<graph::EdgeId> removed;
+        std::vector<graph::EdgeId> added;
+        for (const auto& bus_name : from_buses) {
+            if (to_buses.count(bus_name) == 0) {
+                continue;
+            }
+            const auto bus_removed = RemoveBusFromGraph(bus_name);
+            removed.insert(removed.end(), bus_removed.begin(), bus_removed.end());
+            const Bus* bus = catalogue_.FindBus(bus_name);
+            AddBusIntoGraph(*bus);
+            const auto& bus_added = bus_to_edges_.at(bus->name);
+            added.insert(added.end(), bus_added.begin(), bus_added.end());
+        }
+        UpdateRoutes(added, removed);
+    }
+
+    void TransportRouter::UpdateStopCoordinates(const std::string_view stop_name) {
+        // RAPTOR не использует координаты
+        if (raptor_) {
+            return;
+        }
+        auto vertex = stop_to_vertex_.find(stop_name);
+        if (vertex == stop_to_vertex_.end()) {
+            return;
+        }
+        const Stop* stop = catalogue_.FindStop(stop_name);
+        vertex_points_[vertex->second.first].point = stop->sphere_point;
+        vertex_points_[vertex->second.second].point = stop->sphere_point;
+        // Отношение меняется только у перегонов через эту остановку. Старая граница остаётся
+        // нижней, если она меньше, поэтому её достаточно уменьшить
+        for (const auto& bus_name : catalogue_.GetStopInfo(stop_name)) {
+            min_distance_ratio_ = std::min(min_distance_ratio_, GetMinDistanceRatio(*catalogue_.FindBus(bus_name)));
+        }
     }
 
 } // namespace transport_router
\ No newline at end of file
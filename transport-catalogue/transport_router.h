@@ -3,11 +3,20 @@
 #include "transport_catalogue.h"
 #include "graph.h"
 #include "router.h"
-
+#include "shortest_path_tree.h"
+#include "contraction_hierarchy.h"
+#include "a_star.h"
+#include "bidirectional_search.h"
+#include "k_shortest_paths.h"
+#include "geo.h"
+#include "raptor.h"
+
+#include <limits>
 #include <utility>
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <optional>
 
@@ -15,14 +24,32 @@ namespace transport_router {
 
 using namespace transport_catalogue;
 
+enum class RouteEngine {
+    // Все маршруты предрассчитываются при построении
+    ALL_PAIRS,
+    // Маршрут ищется по запросу, деревья кратчайших путей кэшируются по начальной остановке
+    DIJKSTRA,
+    // Маршрут ищется по иерархии сжатия, построенной заранее
+    CONTRACTION_HIERARCHIES,
+    // Маршрут ищется по запросу алгоритмом A* с оценкой по расстоянию до цели
+    A_STAR,
+    // Маршрут ищется по запросу двунаправленным алгоритмом Дейкстры
+    BIDIRECTIONAL,
+    // Маршрут ищется по раундам пересадок прямо по маршрутам автобусов, граф не строится
+    RAPTOR,
+};
+
 struct RouteSettings {
     double bus_wait_time;
     double bus_velocity;
+    RouteEngine engine = RouteEngine::ALL_PAIRS;
+    std::size_t tree_cache_bytes = 64 << 20;
 };
 
+// Имена ссылаются на хранилище имён справочника и действительны, пока он жив
 struct Item {
-    std::string type;
-    std::string name;
+    std::string_view type;
+    std::string_view name;
     double time;
     int span;
 };
@@ -32,42 +59,162 @@ struct RouteItems {
     std::vector<Item> items;
 };
 
+struct ReachableStop {
+    std::string_view name;
+    double time;
+};
+
+// Строка i, столбец j - время пути от from[i] до to[j], пусто если пути или остановки нет
+using RouteMatrix = std::vector<std::vector<std::optional<double>>>;
+
 class TransportRouter {
 public:
     TransportRouter(const TransportCatalogue& catalogue);
 
+    // Копия other для catalogue - копии справочника, по которому построен other.
+    // Граф и таблицы маршрутов копируются без перестроения, имена берутся из catalogue
+    TransportRouter(const TransportRouter& other, const TransportCatalogue& catalogue);
+
     void SetSettingsAndBuild(RouteSettings settings);
 
     std::optional<RouteItems> GetRouteInfo(const std::string_view from, const std::string_view to) const;
 
+    // До count простых маршрутов по возрастанию времени. Для RouteEngine::RAPTOR графа нет,
+    // и возвращается только лучший маршрут
+    std::vector<RouteItems> GetRouteAlternatives(const std::string_view from, const std::string_view to, std::size_t count) const;
+
+    // Маршруты, оптимальные по Парето по времени и числу пересадок, по возрастанию числа пересадок.
+    // Для движков на графе данные RAPTOR строятся при первом таком запросе
+    std::vector<RouteItems> GetParetoRoutes(const std::string_view from, const std::string_view to, std::size_t max_transfers) const;
+
+    // Считает только время в пути, по одному поиску на каждую начальную остановку
+    RouteMatrix GetRouteMatrix(const std::vector<std::string_view>& from, const std::vector<std::string_view>& to) const;
+
+    // Остановки, до которых можно доехать от from не дольше чем за max_time минут, по возрастанию времени.
+    // Пусто, если остановки нет
+    std::optional<std::vector<ReachableStop>> GetIsochrone(const std::string_view from, double max_time) const;
+
+    // Обновляют граф и маршруты после соответствующего изменения каталога
+    void AddStop(const std::string_view stop_name);
+    void RemoveStop(const std::string_view stop_name);
+    // Добавляет, изменяет или удаляет рёбра автобуса в зависимости от его состояния в каталоге
+    void UpdateBus(const std::string_view bus_name);
+    void UpdateDistance(const std::string_view from, const std::string_view to);
+    // Переносит новые координаты остановки в оценку времени пути A*
+    void UpdateStopCoordinates(const std::string_view stop_name);
+
+    // Строят граф при потоковой загрузке, пока настройки ещё неизвестны. Вызываются из потока,
+    // наполняющего справочник, сразу после добавления остановки или автобуса. Веса рёбер
+    // проставляются в SetSettingsAndBuild, и граф заново не строится
+    void PrepareStop(const Stop& stop);
+    void PrepareBus(const Bus& bus);
+
+    // Статистика кэша деревьев кратчайших путей, пустая для RouteEngine::ALL_PAIRS
+    std::optional<graph::ShortestPathTreeCache<double>::Stats> GetTreeCacheStats() const;
+
+    // Статистика предобработки, пустая для остальных движков
+    std::optional<graph::ContractionHierarchy<double>::Stats> GetContractionStats() const;
+
+    // Память графа, таблиц маршрутов и индексов выбранного движка
+    memory::Report GetMemoryReport() const;
+
 private:
     const TransportCatalogue& catalogue_;
     RouteSettings settings_;
 
     std::unique_ptr<graph::DirectedWeightedGraph<double>> transport_graph_;
     std::unique_ptr<graph::Router<double>> transport_router_;
-
-    std::unordered_map<const Stop*, std::pair<graph::VertexId, graph::VertexId>> stop_to_vertex_;
+    std::unique_ptr<graph::ShortestPathTreeCache<double>> tree_cache_;
+    std::unique_ptr<graph::ContractionHierarchy<double>> contraction_hierarchy_;
+    std::unique_ptr<Raptor> raptor_;
+    mutable std::mutex pareto_raptor_mutex_;
+    mutable std::unique_ptr<Raptor> pareto_raptor_;
+
+    // Ключи - имена из хранилища справочника, так как при удалении из каталога адреса
+    // остановок и автобусов меняются, а имена остаются на месте
+    std::unordered_map<std::string_view, std::pair<graph::VertexId, graph::VertexId>> stop_to_vertex_;
+    // Остановки по вершинам начала ожидания
+    std::unordered_map<graph::VertexId, std::string_view> vertex_to_stop_;
     std::unordered_map<graph::EdgeId, Item> edge_to_item_;
+    std::unordered_map<std::string_view, std::vector<graph::EdgeId>> bus_to_edges_;
+
+    struct VertexPoint {
+        geo::SpherePoint point;
+        bool is_wait_begin = false;
+    };
+    std::vector<VertexPoint> vertex_points_;
+    // Нижняя граница отношения длины дороги к расстоянию по прямой для перегонов всех автобусов.
+    // Может только уменьшаться, поэтому оценка A* остаётся допустимой после обновлений
+    double min_distance_ratio_ = 1.0;
+
+    // Ребро автобуса без учёта настроек: путь от from до to через span_count перегонов
+    struct BusSpan {
+        const Stop* from;
+        const Stop* to;
+        int span_count;
+        double distance;
+    };
+    struct BusSpans {
+        std::vector<BusSpan> spans;
+        double min_distance_ratio = std::numeric_limits<double>::infinity();
+    };
+    // Граф построен PrepareStop и PrepareBus: веса рёбер ещё не проставлены
+    bool is_graph_prepared_ = false;
 
     double DistanceIntoTime(double distance) const;
 
     const std::pair<graph::VertexId, graph::VertexId>& GetVertexFromStop(const Stop* stop) const;
 
+    std::optional<graph::VertexId> FindStopVertex(const std::string_view stop_name) const;
+
+    std::string_view GetStopName(const std::string_view stop_name) const;
+    std::string_view GetBusName(const std::string_view bus_name) const;
+
+    std::optional<double> GetRouteTime(graph::VertexId from, graph::VertexId to) const;
+
+    // Нижняя оценка времени пути от вершины до вершины начала ожидания на целевой остановке
+    double EstimateRouteTime(graph::VertexId from, graph::VertexId to) const;
+
     void AddStopsIntoGraph();
 
-    void AddBusEdgeIntoGraph(
+    graph::EdgeId AddStopIntoGraph(const Stop& stop, graph::VertexId wait_begin, graph::VertexId wait_end);
+
+    graph::EdgeId AddBusEdgeIntoGraph(
         const Stop* from, 
         const Stop* to,
         const std::string_view bus_name,
         int span_count,
-        double distance
+        double time
     );
 
     void AddBusIntoGraph(const Bus& bus);
 
+    BusSpans GetBusSpans(const Bus& bus) const;
+
+    // Наименьшее отношение длины дороги к расстоянию по прямой среди перегонов автобуса
+    double GetMinDistanceRatio(const Bus& bus) const;
+
+    double GetDistanceRatio(const Stop* from, const Stop* to) const;
+
+    std::vector<graph::EdgeId> RemoveBusFromGraph(const std::string_view bus_name);
+
+    void ResetGraph(std::size_t vertex_count);
+
+    void SetPreparedWeights();
+
     void BuildRoute();
 
+    void UpdateRoutes(const std::vector<graph::EdgeId>& added_edges, const std::vector<graph::EdgeId>& removed_edges);
+
+    std::optional<RouteItems> GetRaptorRouteInfo(const std::string_view from, const std::string_view to) const;
+    RouteMatrix GetRaptorRouteMatrix(const std::vector<std::string_view>& from, const std::vector<std::string_view>& to) const;
+    std::optional<std::vector<ReachableStop>> GetRaptorIsochrone(const std::string_view from, double max_time) const;
+
+    RouteItems MakeRouteItems(double total_time, const std::vector<graph::EdgeId>& edges) const;
+    RouteItems MakeRouteItems(const Raptor& raptor, const Raptor::Journey& journey) const;
+
+    const Raptor& GetParetoRaptor() const;
+
 };
 
 } // namespace transport_router
\ No newline at end of file